@@ -39,12 +39,17 @@ void brush(Image & im, int x, int y, vector<float> color, Image &texture) {
 }
 
 void singleScalePaint(Image & im, Image & out, Image & importance, Image & texture, int N, int size, float noise){
+	singleScalePaint(im, out, importance, MipMap(texture), N, size, noise);
+}
+
+void singleScalePaint(Image & im, Image & out, Image & importance, const MipMap & texture, int N, int size, float noise){
 	/* initialize random seed so we can use it throughout*/
   	srand (time(NULL));
 
-	//First, scale the texture image so that it has maximum size size. Use the provided scaleImage function or your own method.
+	//First, scale the texture image so that it has maximum size size. The
+	//mip-chain prefilters, so small brushes do not alias.
 	float scale_factor = float(size)/max(texture.height(), texture.width());
-	Image scaled_texture = scaleLin(texture, scale_factor);
+	Image scaled_texture = texture.scaled(scale_factor);
 
 	/*
 	For each of N random locations y,x splat a brush in out using the above function.
@@ -126,8 +131,10 @@ Image painterly(Image &im, Image &texture, int N, int size, float noise){
 	Image second_pass_importance(im.width(), im.height(), im.channels());
 	second_pass_importance = sharpnessMap(im);
 
-	singleScalePaint(im, out, first_pass_importance, texture, N, size, noise);
-	singleScalePaint(im, out, second_pass_importance, texture, N, size/4, noise);
+	//Both passes resize the brush from the same mip-chain
+	MipMap brushes(texture);
+	singleScalePaint(im, out, first_pass_importance, brushes, N, size, noise);
+	singleScalePaint(im, out, second_pass_importance, brushes, N, size/4, noise);
 	return out;
 }
 
@@ -260,12 +267,17 @@ vector<Image> rotateBrushesForCrossStitch(Image &texture, int n){
 }
 
 void singleScaleOrientedPaint(Image & im, Image & out, Image & importance, Image & texture, int N, int size, float noise, int nAngles, bool useRegularStroke){
+	singleScaleOrientedPaint(im, out, importance, MipMap(texture), N, size, noise, nAngles, useRegularStroke);
+}
+
+void singleScaleOrientedPaint(Image & im, Image & out, Image & importance, const MipMap & texture, int N, int size, float noise, int nAngles, bool useRegularStroke){
 	/* initialize random seed so we can use it throughout*/
   	srand (time(NULL));
 
-	//First, scale the texture image so that it has maximum size size. Use the provided scaleImage function or your own method.
+	//First, scale the texture image so that it has maximum size size, from
+	//the mip-chain
 	float scale_factor = float(size)/max(texture.height(), texture.width());
-	Image scaled_texture = scaleLin(texture, scale_factor);
+	Image scaled_texture = texture.scaled(scale_factor);
 
 	/*
 	For each of N random locations y,x splat a brush in out using the above function.
@@ -327,10 +339,11 @@ Image orientedPaint(Image &im, Image &texture, int N, int size, float noise, boo
 	Image second_pass_importance(im.width(), im.height(), 1);
 	second_pass_importance = sharpnessMap(im);
 
+	MipMap brushes(texture);
 	cout << "Before singleScaleOrientedPaint round 1" << endl;
-	singleScaleOrientedPaint(im, out, first_pass_importance, texture, N, size, noise, 36, useRegularStroke);
+	singleScaleOrientedPaint(im, out, first_pass_importance, brushes, N, size, noise, 36, useRegularStroke);
 	cout << "Before singleScaleOrientedPaint round 2" << endl;
-	singleScaleOrientedPaint(im, out, second_pass_importance, texture, N, size/4, noise, 36, useRegularStroke);
+	singleScaleOrientedPaint(im, out, second_pass_importance, brushes, N, size/4, noise, 36, useRegularStroke);
 
 	return out;
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "basicImageManipulation.h"
 #include "filtering.h"
 #include "matrix.h"
+#include "mipmap.h"
 #include <iostream>
 #include <cmath>
 
@@ -12,6 +13,8 @@
 // files
 void brush(Image & im, int x, int y, vector<float> color, Image &texture);
 void singleScalePaint(Image & im, Image & out, Image & importance, Image & texture, int N = 10000, int size = 50, float noise = 0.3);
+// Same, with the brush resized from a mip-chain built once per texture
+void singleScalePaint(Image & im, Image & out, Image & importance, const MipMap & texture, int N = 10000, int size = 50, float noise = 0.3);
 Image sharpnessMap(Image &im, float sigma = 1.0);
 Image anisotropic_gaussian(Image &im, float sigma = 1.0);
 
@@ -22,6 +25,7 @@ Image painterly(Image &im, Image &texture, int N = 10000, int size = 50, float n
 Image computeTensor(const Image &im, float sigmaG=3, float factorSigma=5);
 Image computeAngles(Image & im);
 void singleScaleOrientedPaint(Image & im, Image & out, Image & importance, Image & texture, int N = 10000, int size = 50, float noise = 0.3, int nAngles = 36, bool useRegularStroke = true);
+void singleScaleOrientedPaint(Image & im, Image & out, Image & importance, const MipMap & texture, int N = 10000, int size = 50, float noise = 0.3, int nAngles = 36, bool useRegularStroke = true);
 vector<Image> rotateBrushes(Image &texture, int n = 36);
 vector<Image> rotateBrushesPerpendicular(Image &texture, int n = 36);
 Image orientedPaint(Image &im, Image &texture, int N = 10000, int size = 50, float noise = 0.3, bool useRegularStroke = true);
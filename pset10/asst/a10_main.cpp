@@ -1,6 +1,7 @@
 #include <iostream>
 #include <cmath>
 #include "a10.h"
+#include "resample.h"
 
 using namespace std;
 
@@ -198,6 +199,119 @@ void testOrientedPaint(){
 	//out.write("Output/testOrientedPaint_stanford_CrossStitch.png");
 }
 
+void testResample(){
+	//Bilinear upsampling matches interpolateLin away from the border
+	Image im(64, 48, 3);
+	for (int i = 0; i < im.number_of_elements(); i++) im(i) = float(rand()) / RAND_MAX;
+	Image up = scaleLin(im, 2.5);
+	float err = 0.0f;
+	for (int z = 0; z < up.channels(); z++)
+	for (int y = 0; y < up.height() - 3; y++)
+	for (int x = 0; x < up.width() - 3; x++)
+		err = max(err, fabs(up(x,y,z) - interpolateLin(im, x/2.5f, y/2.5f, z)));
+	cout << "scaleLin max error vs interpolateLin: " << err << endl;
+
+	//A one pixel checkerboard should shrink to flat gray, not alias
+	Image checker(256, 256, 1);
+	for (int y = 0; y < checker.height(); y++)
+	for (int x = 0; x < checker.width(); x++)
+		checker(x,y,0) = (x + y) % 2;
+	ResampleKernel kernels[3] = {RESAMPLE_BILINEAR, RESAMPLE_BICUBIC, RESAMPLE_LANCZOS3};
+	const char *names[3] = {"bilinear", "bicubic", "lanczos3"};
+	for (int k = 0; k < 3; k++) {
+		Image small = resample(checker, 37, 37, kernels[k]);
+		float dev = 0.0f;
+		for (int i = 0; i < small.number_of_elements(); i++) dev = max(dev, fabs(small(i) - 0.5f));
+		cout << names[k] << " checkerboard max deviation from 0.5: " << dev << endl;
+	}
+	cout << "scaleLin checkerboard range: " << scaleLin(checker, 37.0/256).min()
+	     << " " << scaleLin(checker, 37.0/256).max() << endl;
+}
+
+void testRotateFast(){
+	//Scanline rotate against the per-pixel formula with interpolateLin
+	Image im(73, 51, 3);
+	for (int i = 0; i < im.number_of_elements(); i++) im(i) = float(rand()) / RAND_MAX;
+	float cx = (im.width()-1.0)/2.0, cy = (im.height()-1.0)/2.0;
+	float angles[4] = {0.0f, 0.3f, -float(M_PI)/2, 2.5f};
+	for (int a = 0; a < 4; a++) {
+		float theta = angles[a];
+		Image rot = rotate(im, theta);
+		float err = 0.0f;
+		for (int z = 0; z < im.channels(); z++)
+		for (int y = 0; y < im.height(); y++)
+		for (int x = 0; x < im.width(); x++)
+		{
+			float xR = (x - cx)*cos(theta) + (cy - y)*sin(theta) + cx;
+			float yR = cy - ( -(x - cx)*sin(theta) + (cy - y)*cos(theta) );
+			err = max(err, fabs(rot(x,y,z) - interpolateLin(im, xR, yR, z)));
+		}
+		cout << "rotate(" << theta << ") max error: " << err << endl;
+	}
+
+	Image texture(50, 50, 3);
+	for (int i = 0; i < texture.number_of_elements(); i++) texture(i) = float(rand()) / RAND_MAX;
+	clock_t start = clock();
+	vector<Image> brushes = rotateBrushes(texture, 36);
+	cout << "rotateBrushes(36): " << float(clock() - start) / CLOCKS_PER_SEC << "s" << endl;
+}
+
+void testMipMap(){
+	//On power of two sizes a level is the exact box average, and resizing
+	//to the size of a level returns that level
+	Image im(256, 192, 3);
+	for (int i = 0; i < im.number_of_elements(); i++) im(i) = float(rand()) / RAND_MAX;
+	MipMap mip(im);
+	Image level2 = mip.level(2);
+	float err = 0.0f;
+	for (int z = 0; z < im.channels(); z++)
+	for (int y = 0; y < level2.height(); y++)
+	for (int x = 0; x < level2.width(); x++)
+	{
+		float box = 0.0f;
+		for (int j = 0; j < 4; j++)
+		for (int i = 0; i < 4; i++)
+			box += im(4*x + i, 4*y + j, z) / 16;
+		err = max(err, fabs(level2(x,y,z) - box));
+		err = max(err, fabs(mip.resized(64, 48)(x,y,z) - level2(x,y,z)));
+	}
+	cout << "mipmap levels: " << mip.levels() << ", level 2 max error: " << err << endl;
+
+	//A one pixel checkerboard should shrink to flat gray at any size
+	Image checker(256, 256, 1);
+	for (int y = 0; y < checker.height(); y++)
+	for (int x = 0; x < checker.width(); x++)
+		checker(x,y,0) = (x + y) % 2;
+	MipMap checkerMip(checker);
+	int sizes[3] = {100, 37, 12};
+	for (int k = 0; k < 3; k++) {
+		Image small = checkerMip.resized(sizes[k], sizes[k]);
+		float dev = 0.0f;
+		for (int i = 0; i < small.number_of_elements(); i++) dev = max(dev, fabs(small(i) - 0.5f));
+		cout << "mipmap checkerboard at " << sizes[k] << ": max deviation from 0.5: " << dev << endl;
+	}
+
+	//Brush sizes used by painterly, scaleLin every call against one chain
+	Image texture(200, 200, 3);
+	for (int i = 0; i < texture.number_of_elements(); i++) texture(i) = float(rand()) / RAND_MAX;
+	clock_t start = clock();
+	for (int n = 0; n < 10; n++) {
+		Image a = scaleLin(texture, 50.0/200);
+		Image b = scaleLin(texture, 12.0/200);
+	}
+	float scaleLinTime = float(clock() - start) / CLOCKS_PER_SEC;
+	start = clock();
+	MipMap brushes(texture);
+	float buildTime = float(clock() - start) / CLOCKS_PER_SEC;
+	for (int n = 0; n < 10; n++) {
+		Image a = brushes.scaled(50.0/200);
+		Image b = brushes.scaled(12.0/200);
+	}
+	float mipTime = float(clock() - start) / CLOCKS_PER_SEC;
+	cout << "10x two brush sizes, scaleLin: " << scaleLinTime << "s, mipmap: " << mipTime
+	     << "s (build " << buildTime << "s)" << endl;
+}
+
 int main()
 {
 	srand (time(NULL));
@@ -220,6 +334,9 @@ int main()
     testOrientedPaint_EdgeAlignment();
     testOrientedPaint_CrossStitchEdgeAlignment();
     */
+    testResample();
+    testRotateFast();
+    testMipMap();
     testOrientedPaint();
     
     return EXIT_SUCCESS;
@@ -9,6 +9,8 @@
 
 
 #include "basicImageManipulation.h"
+#include "resample.h"
+#include <algorithm>
 using namespace std;
 
 // --------- HANDOUT PS01 ------------------------------
@@ -365,29 +367,33 @@ Image scaleLin(const Image &im, float factor){
     // return im;
     
     // --------- SOLUTION PS05 ------------------------------
-    float ys, xs; // coordinate in the source image
-
 	// Initialize a new Image factor times bigger (or smaller if factor <1)
     int nWidth  = floor(factor*im.width());
     int nHeight = floor(factor*im.height());
-    Image im2(nWidth, nHeight, im.channels());
-    
-    // For each pixel in the output
-    for (int z=0; z<im.channels(); z++) 
-    for (int y=0; y<nHeight; y++) 
-    for (int x=0; x<nWidth; x++) 
-    {
-        // Get the source pixel value.
-        ys = 1/factor * y;
-        xs = 1/factor * x;
-        im2(x,y,z) = interpolateLin(im, xs, ys, z);
-    }
-    
-	// return new image
-    return im2;
+
+    // Output pixel (x,y) samples the source at (x,y)/factor. The bilinear
+    // weights are computed once per row and per column, and the kernel is
+    // widened when shrinking so that it also prefilters.
+    ResampleTable tx = resampleTable(im.width(),  nWidth,  RESAMPLE_BILINEAR, 1/factor, 0.0f);
+    ResampleTable ty = resampleTable(im.height(), nHeight, RESAMPLE_BILINEAR, 1/factor, 0.0f);
+    return resampleSeparable(im, tx, ty);
 }
 
 
+// Narrow [lo, hi] to the x for which v0 + x*dv lies in (-1, n), the
+// coordinates where a bilinear sample still touches a pixel of a row or
+// column of size n
+static void clipSpan(float v0, float dv, int n, float &lo, float &hi) {
+    if (fabs(dv) < 1e-8f) {
+        if (v0 <= -1.0f || v0 >= n) { lo = 1.0f; hi = 0.0f; }
+        return;
+    }
+    float a = (-1.0f - v0) / dv;
+    float b = (n - v0) / dv;
+    lo = max(lo, min(a, b));
+    hi = min(hi, max(a, b));
+}
+
 Image rotate(const Image &im, float theta) {
     // // --------- HANDOUT  PS05 ------------------------------
     // // (6.865 required, 6.815 extra credit)
@@ -403,24 +409,51 @@ Image rotate(const Image &im, float theta) {
 	// center around which to rotate
     float centerX = (im.width()-1.0)/2.0;
     float centerY = (im.height()-1.0)/2.0;
+    float c = cos(theta), s = sin(theta);
+    int w = im.width(), h = im.height();
     
+	// get new image, black where the source is not sampled
+    Image imR(w, h, im.channels());
     
-	// get new image
-    Image imR(im.width(), im.height(), im.channels());
-    
-    // For each pixel in the output
-    float yR, xR; // rotated coordinates
-    for (int x=0; x<im.width(); x++) 
-    for (int y=0; y<im.height(); y++) 
-    for (int z=0; z<im.channels(); z++) 
-    {
-        
-        // compute the x and y values from the original image
-        xR = (static_cast<float>(x) - centerX)*cos(theta) + (centerY - static_cast<float>(y))*sin(theta) + centerX;
-        yR = centerY - ( -(static_cast<float>(x) - centerX)*sin(theta) + (centerY - static_cast<float>(y))*cos(theta) );
-
-        // interpolate the point
-        imR(x,y,z) = interpolateLin(im, xR, yR, z);
+    #pragma omp parallel for
+    for (int y=0; y<h; y++) {
+        // source coordinates of (0,y); each step along the scanline adds
+        // (cos, sin), so no trigonometry or matrix product per pixel
+        float xRow = -centerX*c + (centerY - y)*s + centerX;
+        float yRow = centerY - centerX*s - (centerY - y)*c;
+
+        // only the output pixels whose source lies in (-1,w) x (-1,h) get
+        // a contribution from the image, the rest of the scanline stays black
+        float lo = 0.0f, hi = w-1.0f;
+        clipSpan(xRow, c, w, lo, hi);
+        clipSpan(yRow, s, h, lo, hi);
+
+        for (int x = max(0, int(floor(lo))); x <= min(w-1, int(ceil(hi))); x++) {
+            float xR = xRow + x*c;
+            float yR = yRow + x*s;
+            int xf = floor(xR);
+            int yf = floor(yR);
+            float xalpha = xR - xf;
+            float yalpha = yR - yf;
+            bool inside = xf >= 0 && yf >= 0 && xf+1 < w && yf+1 < h;
+
+            // the 2x2 neighborhood and its weights are shared by all channels
+            for (int z=0; z<im.channels(); z++) {
+                float tl, tr, bl, br;
+                if (inside) {
+                    tl = im(xf, yf, z);   tr = im(xf+1, yf, z);
+                    bl = im(xf, yf+1, z); br = im(xf+1, yf+1, z);
+                } else {
+                    tl = im.smartAccessor(xf, yf, z, false);
+                    tr = im.smartAccessor(xf+1, yf, z, false);
+                    bl = im.smartAccessor(xf, yf+1, z, false);
+                    br = im.smartAccessor(xf+1, yf+1, z, false);
+                }
+                float topL = tr*xalpha + tl*(1.0f - xalpha);
+                float botL = br*xalpha + bl*(1.0f - xalpha);
+                imR(x,y,z) = botL*yalpha + topL*(1.0f - yalpha);
+            }
+        }
     }
 
     return imR; 
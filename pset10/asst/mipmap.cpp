@@ -0,0 +1,127 @@
+/* --------------------------------------------------------------------------
+ * File:    mipmap.cpp
+ * Created: 2026-10-18
+ * --------------------------------------------------------------------------
+ *
+ * Mip-chain of a texture for prefiltered resizing at any size
+ *
+ * ------------------------------------------------------------------------*/
+
+
+#include "mipmap.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+MipMap::MipMap(const Image &texture) : nc(texture.channels()) {
+    int w = texture.width(), h = texture.height();
+    vector<float> base(w*h*nc);
+    for (int z = 0; z < nc; z++)
+    for (int y = 0; y < h; y++)
+    for (int x = 0; x < w; x++)
+        base[x + w*(y + h*z)] = texture(x, y, z);
+    widths.push_back(w);
+    heights.push_back(h);
+    data.push_back(base);
+
+    while (w > 1 || h > 1) {
+        // odd sizes repeat their last row or column
+        int nw = (w + 1) / 2, nh = (h + 1) / 2;
+        const vector<float> &prev = data.back();
+        vector<float> next(nw*nh*nc);
+        for (int z = 0; z < nc; z++)
+        for (int y = 0; y < nh; y++)
+        {
+            const float *r0 = &prev[w*(2*y + h*z)];
+            const float *r1 = &prev[w*(min(2*y+1, h-1) + h*z)];
+            for (int x = 0; x < nw; x++) {
+                int x0 = 2*x, x1 = min(2*x+1, w-1);
+                next[x + nw*(y + nh*z)] = 0.25f * (r0[x0] + r0[x1] + r1[x0] + r1[x1]);
+            }
+        }
+        w = nw;
+        h = nh;
+        widths.push_back(w);
+        heights.push_back(h);
+        data.push_back(next);
+    }
+}
+
+Image MipMap::level(int i) const {
+    if (i < 0 || i >= levels())
+        throw OutOfBoundsException();
+    int w = widths[i], h = heights[i];
+    Image out(w, h, nc);
+    for (int z = 0; z < nc; z++)
+    for (int y = 0; y < h; y++)
+    for (int x = 0; x < w; x++)
+        out(x, y, z) = data[i][x + w*(y + h*z)];
+    return out;
+}
+
+// Bilinear taps along one side: output sample i of n lands at
+// (i+0.5)*size/n - 0.5 in a level with size samples on that side
+static void levelTaps(int n, int size, vector<int> &i0, vector<int> &i1, vector<float> &alpha) {
+    i0.resize(n);
+    i1.resize(n);
+    alpha.resize(n);
+    float step = float(size) / n;
+    for (int i = 0; i < n; i++) {
+        float u = min(max((i + 0.5f)*step - 0.5f, 0.0f), float(size - 1));
+        int f = int(u);
+        i0[i] = f;
+        i1[i] = min(f + 1, size - 1);
+        alpha[i] = u - f;
+    }
+}
+
+Image MipMap::resized(int width, int height) const {
+    if (width < 1 || height < 1)
+        throw NegativeDimensionException();
+
+    // level of detail from the strongest minification, so that neither
+    // direction aliases
+    float ratio = max(float(widths[0]) / width, float(heights[0]) / height);
+    float lod = min(max(log2(ratio), 0.0f), float(levels() - 1));
+    int l0 = int(lod);
+    int l1 = min(l0 + 1, levels() - 1);
+    float t = lod - l0;
+
+    // taps are shared by every row, column and channel
+    int ls[2] = {l0, l1};
+    vector<int> xi0[2], xi1[2], yi0[2], yi1[2];
+    vector<float> xa[2], ya[2];
+    for (int k = 0; k < 2; k++) {
+        levelTaps(width,  widths[ls[k]],  xi0[k], xi1[k], xa[k]);
+        levelTaps(height, heights[ls[k]], yi0[k], yi1[k], ya[k]);
+    }
+
+    Image out(width, height, nc);
+    #pragma omp parallel for
+    for (int y = 0; y < height; y++) {
+        for (int z = 0; z < nc; z++) {
+            float v[2];
+            for (int x = 0; x < width; x++) {
+                for (int k = 0; k < 2; k++) {
+                    int w = widths[ls[k]], h = heights[ls[k]];
+                    const float *plane = &data[ls[k]][w*h*z];
+                    const float *r0 = plane + w*yi0[k][y];
+                    const float *r1 = plane + w*yi1[k][y];
+                    float a = xa[k][x];
+                    float top = r0[xi0[k][x]] + a*(r0[xi1[k][x]] - r0[xi0[k][x]]);
+                    float bot = r1[xi0[k][x]] + a*(r1[xi1[k][x]] - r1[xi0[k][x]]);
+                    v[k] = top + ya[k][y]*(bot - top);
+                }
+                out(x, y, z) = v[0] + t*(v[1] - v[0]);
+            }
+        }
+    }
+    return out;
+}
+
+Image MipMap::scaled(float factor) const {
+    int w = max(int(floor(factor*widths[0])), 1);
+    int h = max(int(floor(factor*heights[0])), 1);
+    return resized(w, h);
+}
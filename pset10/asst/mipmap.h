@@ -0,0 +1,47 @@
+/* --------------------------------------------------------------------------
+ * File:    mipmap.h
+ * Created: 2026-10-18
+ * --------------------------------------------------------------------------
+ *
+ * Mip-chain of a texture for prefiltered resizing at any size
+ *
+ * ------------------------------------------------------------------------*/
+
+
+#ifndef __mipmap__h
+#define __mipmap__h
+
+#include "Image.h"
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+// Level 0 is the texture, every following level averages 2x2 blocks of the
+// previous one, down to 1x1. Build it once per texture, then any size is
+// produced in time proportional to the output.
+class MipMap {
+public:
+    explicit MipMap(const Image &texture);
+
+    int levels() const { return int(data.size()); }
+    int channels() const { return nc; }
+    int width(int level=0) const { return widths[level]; }
+    int height(int level=0) const { return heights[level]; }
+    Image level(int i) const;
+
+    // Trilinear resize to width x height with pixel centers aligned: each
+    // output pixel is interpolated bilinearly in the two levels around its
+    // footprint, and the two samples are blended.
+    Image resized(int width, int height) const;
+
+    // Same dimensions as scaleLin(texture, factor), at least 1x1
+    Image scaled(float factor) const;
+
+private:
+    int nc;
+    vector<int> widths, heights;
+    vector< vector<float> > data; // planar, x + w*(y + h*z)
+};
+
+#endif
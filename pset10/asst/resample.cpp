@@ -0,0 +1,138 @@
+/* --------------------------------------------------------------------------
+ * File:    resample.cpp
+ * Created: 2026-10-18
+ * --------------------------------------------------------------------------
+ *
+ * Separable resampling with precomputed index/weight tables
+ *
+ * ------------------------------------------------------------------------*/
+
+
+#include "resample.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+static inline int clampIndex(int i, int n) {
+    return i < 0 ? 0 : (i >= n ? n-1 : i);
+}
+
+static float kernelSupport(ResampleKernel kernel) {
+    switch (kernel) {
+        case RESAMPLE_BICUBIC:  return 2.0f;
+        case RESAMPLE_LANCZOS3: return 3.0f;
+        default:                return 1.0f;
+    }
+}
+
+static inline float sinc(float t) {
+    if (fabs(t) < 1e-6f) return 1.0f;
+    float pt = float(M_PI) * t;
+    return sin(pt) / pt;
+}
+
+static float kernelValue(ResampleKernel kernel, float t) {
+    t = fabs(t);
+    switch (kernel) {
+        case RESAMPLE_BICUBIC: {
+            const float a = -0.5f;
+            if (t < 1.0f) return ((a+2.0f)*t - (a+3.0f))*t*t + 1.0f;
+            if (t < 2.0f) return ((a*t - 5.0f*a)*t + 8.0f*a)*t - 4.0f*a;
+            return 0.0f;
+        }
+        case RESAMPLE_LANCZOS3:
+            return t < 3.0f ? sinc(t) * sinc(t/3.0f) : 0.0f;
+        default:
+            return t < 1.0f ? 1.0f - t : 0.0f;
+    }
+}
+
+
+ResampleTable resampleTable(int inSize, int outSize, ResampleKernel kernel, float step, float offset) {
+    // stretch the kernel when minifying
+    float scale = max(step, 1.0f);
+    float support = kernelSupport(kernel) * scale;
+
+    ResampleTable table;
+    table.inSize = inSize;
+    table.outSize = outSize;
+    table.taps = int(ceil(2.0f*support)) + 1;
+    table.index.assign(outSize*table.taps, 0);
+    table.weight.assign(outSize*table.taps, 0.0f);
+
+    for (int i = 0; i < outSize; i++) {
+        float center = i*step + offset;
+        int first = int(ceil(center - support));
+        int *idx = &table.index[i*table.taps];
+        float *w = &table.weight[i*table.taps];
+        float sum = 0.0f;
+        for (int k = 0; k < table.taps; k++) {
+            int j = first + k;
+            idx[k] = clampIndex(j, inSize);
+            w[k] = kernelValue(kernel, (j - center) / scale);
+            sum += w[k];
+        }
+        if (sum != 0.0f) {
+            for (int k = 0; k < table.taps; k++) w[k] /= sum;
+        }
+    }
+    return table;
+}
+
+
+Image resampleSeparable(const Image &im, const ResampleTable &tx, const ResampleTable &ty) {
+    if (tx.inSize != im.width() || ty.inSize != im.height())
+        throw MismatchedDimensionsException();
+
+    int w = im.width(), h = im.height(), c = im.channels();
+    int ow = tx.outSize, oh = ty.outSize;
+
+    // planar copies so that the inner loops run on contiguous memory
+    vector<float> in(w*h*c);
+    for (int z = 0; z < c; z++)
+    for (int y = 0; y < h; y++)
+    for (int x = 0; x < w; x++)
+        in[(z*h + y)*w + x] = im(x, y, z);
+
+    // along x, input rows to output width
+    vector<float> tmp(ow*h*c);
+    #pragma omp parallel for
+    for (int r = 0; r < h*c; r++) {
+        const float *src = &in[r*w];
+        float *dst = &tmp[r*ow];
+        for (int x = 0; x < ow; x++) {
+            const int *idx = &tx.index[x*tx.taps];
+            const float *wt = &tx.weight[x*tx.taps];
+            float accum = 0.0f;
+            for (int k = 0; k < tx.taps; k++) accum += wt[k] * src[idx[k]];
+            dst[x] = accum;
+        }
+    }
+
+    // along y, whole rows weighted at once
+    Image out(ow, oh, c);
+    #pragma omp parallel for
+    for (int r = 0; r < oh*c; r++) {
+        int z = r / oh, y = r % oh;
+        vector<float> row(ow, 0.0f);
+        const int *idx = &ty.index[y*ty.taps];
+        const float *wt = &ty.weight[y*ty.taps];
+        for (int k = 0; k < ty.taps; k++) {
+            if (wt[k] == 0.0f) continue;
+            const float *src = &tmp[(z*h + idx[k])*ow];
+            for (int x = 0; x < ow; x++) row[x] += wt[k] * src[x];
+        }
+        for (int x = 0; x < ow; x++) out(x, y, z) = row[x];
+    }
+    return out;
+}
+
+
+Image resample(const Image &im, int width, int height, ResampleKernel kernel) {
+    float stepX = float(im.width()) / width;
+    float stepY = float(im.height()) / height;
+    ResampleTable tx = resampleTable(im.width(), width, kernel, stepX, 0.5f*stepX - 0.5f);
+    ResampleTable ty = resampleTable(im.height(), height, kernel, stepY, 0.5f*stepY - 0.5f);
+    return resampleSeparable(im, tx, ty);
+}
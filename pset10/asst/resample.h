@@ -0,0 +1,46 @@
+/* --------------------------------------------------------------------------
+ * File:    resample.h
+ * Created: 2026-10-18
+ * --------------------------------------------------------------------------
+ *
+ * Separable resampling with precomputed index/weight tables
+ *
+ * ------------------------------------------------------------------------*/
+
+
+#ifndef __resample__h
+#define __resample__h
+
+#include "Image.h"
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+enum ResampleKernel {
+    RESAMPLE_BILINEAR, // tent, support 1
+    RESAMPLE_BICUBIC,  // Keys cubic with a=-0.5, support 2
+    RESAMPLE_LANCZOS3  // windowed sinc, support 3
+};
+
+// Taps of a 1D resampling: output sample i is the sum over k < taps of
+// weight[i*taps+k] times input sample index[i*taps+k]. Indices are already
+// clamped to the input, unused taps have a zero weight.
+struct ResampleTable {
+    int inSize, outSize, taps;
+    vector<int> index;
+    vector<float> weight;
+};
+
+// Table of output sample i taken at input coordinate i*step + offset. When
+// step > 1 (minification) the kernel is stretched by step so that it also
+// acts as the antialiasing prefilter. Weights are normalized.
+ResampleTable resampleTable(int inSize, int outSize, ResampleKernel kernel, float step, float offset);
+
+// Apply a table along x then a table along y
+Image resampleSeparable(const Image &im, const ResampleTable &tx, const ResampleTable &ty);
+
+// Resize to width x height with pixel centers aligned
+Image resample(const Image &im, int width, int height, ResampleKernel kernel=RESAMPLE_BILINEAR);
+
+#endif
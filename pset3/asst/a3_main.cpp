@@ -13,6 +13,9 @@
 #include "basicImageManipulation.h"
 #include "demosaic.h"
 #include "align.h"
+#include "median.h"
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
@@ -106,6 +109,216 @@ int main() {
     std::cout << std::endl;
     */
     
+    // Burst statistics ---------------------------
+    // The streaming mean and variance against a two-pass computation, and
+    // the same statistics with frames loaded one at a time from disk
+    {
+        vector<Image> burst;
+        for (int i = 0; i < 30; i++) {
+            Image frame(40, 30, 3);
+            for (int j = 0; j < frame.number_of_elements(); j++) {
+                frame(j) = 0.5f + 0.1f*float(j % 7) + 0.05f*float(rand()) / RAND_MAX;
+            }
+            burst.push_back(frame);
+        }
+        Image mean = denoiseSeq(burst);
+        BurstStats stats;
+        for (auto & im : burst) stats.add(im);
+        Image var = stats.variance();
+        float meanErr = 0.0f, varErr = 0.0f;
+        for (int j = 0; j < mean.number_of_elements(); j++) {
+            double m = 0.0, v = 0.0;
+            for (auto & im : burst) m += im(j);
+            m /= burst.size();
+            for (auto & im : burst) v += (im(j) - m)*(im(j) - m);
+            v /= burst.size() - 1;
+            meanErr = max(meanErr, float(fabs(mean(j) - m)));
+            varErr = max(varErr, float(fabs(var(j) - v) / v));
+        }
+        cout << "streaming mean max error: " << meanErr << ", variance max relative error: " << varErr << endl;
+
+        vector<string> files;
+        vector<Image> frames;
+        for (int i = 1; i <= 8; ++i) {
+            ostringstream fname;
+            fname << "./Input/aligned-ISO400/1D2N-iso400-under-" << i << ".png";
+            files.push_back(fname.str());
+            frames.push_back(Image(fname.str()));
+        }
+        BurstStats lazy = burstStats(files);
+        Image lazyMean = lazy.mean(), eagerMean = denoiseSeq(frames);
+        float lazyErr = 0.0f;
+        for (int j = 0; j < lazyMean.number_of_elements(); j++) {
+            lazyErr = max(lazyErr, fabs(lazyMean(j) - eagerMean(j)));
+        }
+        cout << "lazily loaded burst of " << lazy.count() << " frames, mean max difference: " << lazyErr << endl;
+    }
+
+    // Tile merge ---------------------------
+    // A burst whose two halves move differently, with an object moving
+    // across it: one global shift blurs it, per-tile alignment and robust
+    // weights do not
+    {
+        int w = doge_small.width(), h = doge_small.height();
+        vector<Image> burst, clean;
+        for (int i = 0; i < 8; i++) {
+            Image frame(w, h, doge_small.channels());
+            int lx = (i % 3) - 1, ly = i % 2, rx = -(i % 4), ry = (i % 3);
+            for (int z = 0; z < frame.channels(); z++)
+            for (int y = 0; y < h; y++)
+            for (int x = 0; x < w; x++)
+            {
+                int sx = x < w/2 ? x - lx : x - rx, sy = x < w/2 ? y - ly : y - ry;
+                frame(x, y, z) = doge_small(min(max(sx, 0), w-1), min(max(sy, 0), h-1), z);
+                // moving square
+                if (x >= 10 + 12*i && x < 30 + 12*i && y >= 100 && y < 120) frame(x, y, z) = 1.0f;
+            }
+            clean.push_back(frame);
+            for (int j = 0; j < frame.number_of_elements(); j++) {
+                // gaussian noise, sigma 0.03
+                float u1 = (rand() + 1.0f) / (RAND_MAX + 2.0f), u2 = float(rand()) / RAND_MAX;
+                frame(j) += 0.03f * sqrt(-2*log(u1)) * cos(2*M_PI*u2);
+            }
+            burst.push_back(frame);
+        }
+        Image *results[3];
+        Image merged = mergeBurst(burst, 16, 8);
+        Image global = alignAndDenoise(burst, 8);
+        results[0] = &burst[0];
+        results[1] = &global;
+        results[2] = &merged;
+        const char *names[3] = {"reference frame", "global align and average", "tile merge"};
+        for (int k = 0; k < 3; k++) {
+            double err = 0.0;
+            for (int j = 0; j < clean[0].number_of_elements(); j++) {
+                err += pow((*results[k])(j) - clean[0](j), 2);
+            }
+            cout << names[k] << " rms error: " << sqrt(err / clean[0].number_of_elements()) << endl;
+        }
+        merged.write("./Output/tile_merge.png");
+    }
+
+    // Alignment ---------------------------
+    // The pyramid search should find the same offsets as trying every shift
+    {
+        Image *plates[3] = {&doge_2, &doge_3, &doge_4};
+        for (int i = 0; i < 3; i++) {
+            clock_t start = clock();
+            vector<int> fast = align(doge_small, *plates[i], 20);
+            float fastTime = float(clock() - start) / CLOCKS_PER_SEC;
+            start = clock();
+            vector<int> brute = alignBruteForce(doge_small, *plates[i], 20);
+            float bruteTime = float(clock() - start) / CLOCKS_PER_SEC;
+            cout << "doge_" << i+2 << " pyramid: " << fast[0] << " " << fast[1] << " (" << fastTime << "s)"
+                 << ", brute force: " << brute[0] << " " << brute[1] << " (" << bruteTime << "s)" << endl;
+        }
+        Image rolled = roll(samoyed, -17, 12);
+        vector<int> offset = align(samoyed, rolled, 20);
+        cout << "samoyed rolled by (-17, 12) aligned with " << offset[0] << " " << offset[1]
+             << ", should be 17 -12" << endl;
+    }
+
+    // On a Sergey plate, the pyramid against the original loop that scores
+    // a roll() copy for every shift
+    {
+        auto rollAlign = [](const Image &im1, const Image &im2, int maxOffset) {
+            int x = 0, y = 0;
+            float best = FLT_MAX;
+            for (int dx = -maxOffset; dx <= maxOffset; dx++)
+            for (int dy = -maxOffset; dy <= maxOffset; dy++)
+            {
+                Image rolled = roll(im2, dx, dy);
+                float err = 0;
+                for (int a = maxOffset; a < im1.width() - maxOffset; a++)
+                for (int b = maxOffset; b < im1.height() - maxOffset; b++)
+                for (int c = 0; c < im1.channels(); c++)
+                    err += pow(rolled(a,b,c) - im1(a,b,c), 2);
+                if (err < best) { best = err; x = dx; y = dy; }
+            }
+            return vector<int> {x, y};
+        };
+
+        Image plates = split(Image("./Input/Sergey/00088v_third.png"));
+        vector<Image> channel;
+        for (int z = 0; z < 3; z++) {
+            channel.push_back(Image(plates.width(), plates.height(), 1));
+            for (int b = 0; b < plates.height(); b++)
+            for (int a = 0; a < plates.width(); a++)
+                channel[z](a,b) = plates(a,b,z);
+        }
+        const char *names[3] = {"red", "green", "blue"};
+        for (int z = 1; z < 3; z++) {
+            clock_t start = clock();
+            vector<int> fast = align(channel[0], channel[z], 10);
+            float fastTime = float(clock() - start) / CLOCKS_PER_SEC;
+            start = clock();
+            vector<int> rolled = rollAlign(channel[0], channel[z], 10);
+            float rollTime = float(clock() - start) / CLOCKS_PER_SEC;
+            cout << "Sergey " << names[z] << " to red, pyramid: " << fast[0] << " " << fast[1]
+                 << " (" << fastTime << "s), roll loop: " << rolled[0] << " " << rolled[1]
+                 << " (" << rollTime << "s)" << endl;
+        }
+    }
+
+    // alignAndDenoise streams the aligned frames into the mean, it should
+    // match aligning every frame first and averaging them
+    {
+        vector<Image> burst;
+        for (int i = 0; i < 6; i++) {
+            burst.push_back(roll(doge_small, 3*(i % 3) - 3, 2*(i % 2)));
+        }
+        clock_t start = clock();
+        Image streamed = alignAndDenoise(burst, 8);
+        float streamedTime = float(clock() - start) / CLOCKS_PER_SEC;
+        vector<Image> shifted;
+        for (auto & im : burst) {
+            vector<int> shift = align(burst[0], im, 8);
+            shifted.push_back(roll(im, shift[0], shift[1]));
+        }
+        Image reference = denoiseSeq(shifted);
+        float err = 0.0f;
+        for (int j = 0; j < reference.number_of_elements(); j++) {
+            err = max(err, fabs(streamed(j) - reference(j)));
+        }
+        cout << "streamed alignAndDenoise max difference: " << err << " (" << streamedTime << "s)" << endl;
+
+        vector<string> files;
+        vector<Image> frames;
+        for (int i = 1; i <= 4; ++i) {
+            ostringstream fname;
+            fname << "./Input/aligned-ISO400/1D2N-iso400-under-" << i << ".png";
+            files.push_back(fname.str());
+            frames.push_back(Image(fname.str()));
+        }
+        Image fromFiles = alignAndDenoise(files, 4), fromMemory = alignAndDenoise(frames, 4);
+        err = 0.0f;
+        for (int j = 0; j < fromFiles.number_of_elements(); j++) {
+            err = max(err, fabs(fromFiles(j) - fromMemory(j)));
+        }
+        cout << "alignAndDenoise from files max difference: " << err << endl;
+    }
+
+    // Phase correlation recovers integer and fractional shifts of any size
+    {
+        Image *plates[3] = {&doge_2, &doge_3, &doge_4};
+        for (int i = 0; i < 3; i++) {
+            vector<float> shift = alignPhaseCorrelation(doge_small, *plates[i]);
+            vector<int> search = align(doge_small, *plates[i], 20);
+            cout << "doge_" << i+2 << " phase correlation: " << shift[0] << " " << shift[1]
+                 << ", search: " << search[0] << " " << search[1] << endl;
+        }
+        float shifts[3][2] = {{3.25f, -5.5f}, {-0.4f, 0.7f}, {40.6f, 25.3f}};
+        for (int i = 0; i < 3; i++) {
+            Image moved = translate(samoyed, shifts[i][0], shifts[i][1]);
+            clock_t start = clock();
+            vector<float> shift = alignPhaseCorrelation(samoyed, moved);
+            float phaseTime = float(clock() - start) / CLOCKS_PER_SEC;
+            cout << "samoyed translated by (" << shifts[i][0] << ", " << shifts[i][1] << ") aligned with "
+                 << shift[0] << " " << shift[1] << ", should be " << -shifts[i][0] << " " << -shifts[i][1]
+                 << " (" << phaseTime << "s)" << endl;
+        }
+    }
+
     // Demosaic ---------------------------
     /*
     Image raw("./Input/raw/signs-small.png");
@@ -133,6 +346,84 @@ int main() {
     rgb_greenBasedRorB.write("./Output/demosaiced_greenBasedRorB.png");
     */
 
+    // The fused kernel should match the separate green and red/blue passes
+    // exactly, whatever the Bayer layout
+    {
+        Image raw("./Input/raw/signs-small.png");
+        BayerPattern patterns[4] = {BAYER_RGGB, BAYER_BGGR, BAYER_GRBG, BAYER_GBRG};
+        const char *names[4] = {"RGGB", "BGGR", "GRBG", "GBRG"};
+        int redX[4] = {0, 1, 1, 0}, redY[4] = {0, 1, 0, 1};
+        for (int i = 0; i < 4; i++) {
+            int offsetGreen = (redX[i] + redY[i]) % 2 == 1 ? 0 : 1;
+            clock_t start = clock();
+            Image green = edgeBasedGreen(raw, offsetGreen);
+            Image red = greenBasedRorB(raw, green, redX[i], redY[i]);
+            Image blue = greenBasedRorB(raw, green, 1 - redX[i], 1 - redY[i]);
+            float passesTime = float(clock() - start) / CLOCKS_PER_SEC;
+            start = clock();
+            Image fused = improvedDemosaic(raw, patterns[i]);
+            float fusedTime = float(clock() - start) / CLOCKS_PER_SEC;
+            float err = 0.0f;
+            for (int y = 0; y < raw.height(); y++)
+            for (int x = 0; x < raw.width(); x++)
+            {
+                err = max(err, fabs(fused(x, y, 0) - red(x, y)));
+                err = max(err, fabs(fused(x, y, 1) - green(x, y)));
+                err = max(err, fabs(fused(x, y, 2) - blue(x, y)));
+            }
+            cout << names[i] << " fused demosaic max difference: " << err << " (" << fusedTime
+                 << "s, separate passes " << passesTime << "s)" << endl;
+        }
+    }
+
+    // Median filters ---------------------------
+    // Compare the histogram median with a direct sort of the window, and
+    // clean up a burst with outliers using the temporal median
+    {
+        srand(0);
+        Image noisy(70, 45, 2);
+        for (int i = 0; i < noisy.number_of_elements(); i++) {
+            noisy(i) = float(rand()) / RAND_MAX;
+        }
+        int radius = 3;
+        for (int bits = 8; bits <= 16; bits += 8) {
+            int levels = 1 << bits;
+            Image med = medianFilter(noisy, radius, bits);
+            Image p90 = percentileFilter(noisy, radius, 0.9, bits);
+            int mismatches = 0;
+            for (int z = 0; z < noisy.channels(); z++)
+            for (int y = 0; y < noisy.height(); y++)
+            for (int x = 0; x < noisy.width(); x++)
+            {
+                vector<int> window;
+                for (int dy = -radius; dy <= radius; dy++)
+                for (int dx = -radius; dx <= radius; dx++)
+                {
+                    float v = noisy(min(max(x+dx, 0), noisy.width()-1), min(max(y+dy, 0), noisy.height()-1), z);
+                    window.push_back(int(v*(levels-1) + 0.5f));
+                }
+                sort(window.begin(), window.end());
+                int n = window.size();
+                if (int(med(x,y,z)*(levels-1) + 0.5f) != window[int(0.5f*(n-1) + 0.5f)]) mismatches++;
+                if (int(p90(x,y,z)*(levels-1) + 0.5f) != window[int(0.9f*(n-1) + 0.5f)]) mismatches++;
+            }
+            cout << bits << "-bit median/percentile mismatches: " << mismatches << endl;
+        }
+
+        vector<Image> burst;
+        for (int i = 0; i < 7; i++) {
+            Image frame = noisy;
+            frame(rand() % frame.number_of_elements()) = 1.0f; // hot pixel
+            burst.push_back(frame);
+        }
+        Image tmed = temporalMedian(burst);
+        float maxErr = 0.0f;
+        for (int i = 0; i < noisy.number_of_elements(); i++) {
+            maxErr = max(maxErr, fabs(tmed(i) - noisy(i)));
+        }
+        cout << "temporal median max error with outliers: " << maxErr << endl;
+    }
+
     //
     // // Sergey ---------------------------
     Image sergeyImg("./Input/Sergey/00088v_third.png");
@@ -10,90 +10,77 @@
 
 
 #include "align.h"
+#include "alignSearch.h"
+#include "fft.h"
+#include <algorithm>
+#include <functional>
 
 using namespace std;
 
 Image denoiseSeq(const vector<Image> &imSeq){
     // // --------- HANDOUT  PS03 ------------------------------
     // Basic denoising by computing the average of a sequence of images
-    Image output(imSeq.at(0).width(), imSeq.at(0).height(), imSeq.at(0).channels());
-    
+    // Running mean, no per-frame temporaries
+    BurstStats stats;
     for (auto & im : imSeq) {
-        output = output + im/imSeq.size();
+        stats.add(im);
     }
-
-    return output;
-    
+    return stats.mean();
 }
 
 Image variance(const vector<Image> &imSeq){
-    Image orig_expected_value = denoiseSeq(imSeq);
-
-    std::cout << "In variance_squared method" << std::endl;
-
-    vector<Image> inner_expression;
-    for (auto & im : imSeq){
-        Image difference = orig_expected_value - im;
-        inner_expression.push_back(difference * difference);
-    }
-
-    Image output(imSeq.at(0).width(), imSeq.at(0).height(), imSeq.at(0).channels());
-    for (auto & im: inner_expression){
-        output = output + im;
-    }
-
-    output = output/(inner_expression.size() - 1);
-
-    for (int i = 0; i < output.number_of_elements(); i++){
-        if (output(i) == 0) {
-            std::cout << "ZERO" << std::endl;
-            output(i) = 0.000000001;
-        }
+    BurstStats stats;
+    for (auto & im : imSeq) {
+        stats.add(im);
     }
-
-    return output;
+    return stats.variance();
 }
 
 Image logSNR(const vector<Image> &imSeq, float scale){
     // // --------- HANDOUT  PS03 ------------------------------
     // returns an image visualizing the per-pixel and
     // per-channel log of the signal-to-noise ratio scaled by scale.
-    
-
-    std::cout << "In logSNR" << std::endl;
-
-    Image sigma_squared = variance(imSeq);
-    sigma_squared.write("./Output/snr_sigma_squared.png");
-    
-    std::cout << "computed sigma_squared" << std::endl;
-
-    vector<Image> imSeq_squared;
-    for (auto & im : imSeq){
-        imSeq_squared.push_back(im*im);
+    // Mean, variance and E[x^2] all come from a single pass over the
+    // sequence.
+    BurstStats stats;
+    for (auto & im : imSeq) {
+        stats.add(im);
     }
-    Image expected_im_squared = denoiseSeq(imSeq_squared); 
-    expected_im_squared.write("./Output/snr_expected_im_squared.png");
+    stats.variance().write("./Output/snr_sigma_squared.png");
+    stats.meanSquare().write("./Output/snr_expected_im_squared.png");
+    return stats.logSNR(scale);
+}
 
-    std::cout << "computed expected_im_squared" << std::endl;
 
-    Image SNR(imSeq.at(0).width(), imSeq.at(0).height(), imSeq.at(0).channels()); 
-    for (int a = 0; a < sigma_squared.width(); a++){
-        for (int b = 0; b < sigma_squared.height(); b++){
-            for (int c = 0; c < sigma_squared.channels(); c++){
-                SNR(a,b,c) = 10*log10(expected_im_squared(a,b,c)/sigma_squared(a,b,c));
-            }
-        }
+vector<int> align(const Image &im1, const Image &im2, int maxOffset){
+    // Coarse-to-fine on a pyramid of 2x2 averages, see pyramidSearch
+    const int ALIGN_MIN_LEVEL_SIZE = 32;
+    if (im1.width() != im2.width() || im1.height() != im2.height() || im1.channels() != im2.channels())
+        throw MismatchedDimensionsException();
+
+    // stop once the offsets fit in a few pixels or the level gets too small
+    int levels = 1;
+    while ((maxOffset >> levels) >= 2
+            && min(im1.width() >> (levels-1), im1.height() >> (levels-1)) / 2
+               >= ALIGN_MIN_LEVEL_SIZE + 2*(maxOffset >> levels)) {
+        levels++;
+    }
+    vector<AlignPlane> pyr1 = planePyramid(toPlane(im1), levels);
+    vector<AlignPlane> pyr2 = planePyramid(toPlane(im2), levels);
+
+    // every level ignores the pixels within its largest shift of the edges
+    vector<AlignRect> rects;
+    for (int l = 0; l < levels; l++) {
+        int limit = (maxOffset + (1 << l) - 1) >> l;
+        rects.push_back(AlignRect {limit, limit, pyr1[l].w - limit, pyr1[l].h - limit});
     }
 
-    SNR = SNR*scale;
-
-    std::cout << "computed SNR" << std::endl;
-
-    return SNR;
+    int x = 0, y = 0;
+    pyramidSearch(pyr1, pyr2, rects, maxOffset, true, x, y);
+    return vector<int> {x,y};
 }
 
-
-vector<int> align(const Image &im1, const Image &im2, int maxOffset){
+vector<int> alignBruteForce(const Image &im1, const Image &im2, int maxOffset){
     // // --------- HANDOUT  PS03 ------------------------------
     // returns the (x,y) offset that best aligns im2 to match im1.
     /*
@@ -108,48 +95,164 @@ vector<int> align(const Image &im1, const Image &im2, int maxOffset){
     It circularly shifts an image, causing borders to wrap around. However, since you will be ignoring boundary pixels,
     wrapping the pixel values should not be a problem. Make sure to test your procedure before moving on.
     */
+    if (im1.width() != im2.width() || im1.height() != im2.height() || im1.channels() != im2.channels())
+        throw MismatchedDimensionsException();
 
+    // every shift, the rolled pixels are read in place instead of from a
+    // rolled copy
+    AlignPlane a = toPlane(im1), b = toPlane(im2);
+    AlignRect rect = {maxOffset, maxOffset, a.w - maxOffset, a.h - maxOffset};
     int x = 0;
     int y = 0;
-    float best_squared_error_norm = FLT_MAX;
-    for (int x_offset = -maxOffset; x_offset <= maxOffset; x_offset++){
-        for (int y_offset = -maxOffset; y_offset <= maxOffset; y_offset++){
-            Image rolled_im2 = roll(im2, x_offset, y_offset);
-            float squared_error_norm = 0;
-            for (int a = maxOffset; a < im1.width() - maxOffset; a++){
-                for (int b = maxOffset; b < im1.height() - maxOffset; b++){
-                    for (int c = 0; c < im1.channels(); c++){
-                        squared_error_norm += pow(rolled_im2(a,b,c) - im1(a,b,c),2);
-                    }
-                }
-            }
-            if (squared_error_norm < best_squared_error_norm) {
-                best_squared_error_norm = squared_error_norm;
-                x = x_offset;
-                y = y_offset; 
+    searchWindow(a, b, rect, 0, 0, maxOffset, maxOffset, true, x, y);
+    return vector<int> {x,y};
+}
+
+// Offset from 0 of the apex of the Gaussian through (-1, a), (0, b), (1, c),
+// i.e. of the parabola through their logs
+static float gaussianPeak(float a, float b, float c) {
+    if (a <= 0 || b <= 0 || c <= 0) {
+        // fall back to the parabola through the values
+        float denom = a - 2*b + c;
+        return denom < 0 ? min(max(0.5f * (a - c) / denom, -0.5f), 0.5f) : 0.0f;
+    }
+    float la = log(a), lb = log(b), lc = log(c);
+    float denom = la - 2*lb + lc;
+    if (denom >= 0) return 0.0f;
+    return min(max(0.5f * (la - lc) / denom, -0.5f), 0.5f);
+}
+
+vector<float> alignPhaseCorrelation(const Image &im1, const Image &im2){
+    if (im1.width() != im2.width() || im1.height() != im2.height())
+        throw MismatchedDimensionsException();
+    int w = im1.width(), h = im1.height();
+    int fw = nextPow2(w), fh = nextPow2(h);
+
+    // channel average under a Hann window, zero padded to powers of two.
+    // The window hides the image borders, which would otherwise correlate
+    // best at no shift.
+    vector<Complex> f1(fw*fh), f2(fw*fh);
+    for (int y = 0; y < h; y++) {
+        float wy = 0.5f - 0.5f*cos(2*M_PI*(y + 0.5f)/h);
+        for (int x = 0; x < w; x++) {
+            float wxy = wy * (0.5f - 0.5f*cos(2*M_PI*(x + 0.5f)/w));
+            float v1 = 0.0f, v2 = 0.0f;
+            for (int z = 0; z < im1.channels(); z++) v1 += im1(x, y, z);
+            for (int z = 0; z < im2.channels(); z++) v2 += im2(x, y, z);
+            f1[x + fw*y] = wxy * v1 / im1.channels();
+            f2[x + fw*y] = wxy * v2 / im2.channels();
+        }
+    }
+    fft2D(f1, fw, fh);
+    fft2D(f2, fw, fh);
+
+    // Normalized cross-power spectrum, its inverse peaks at the shift. The
+    // Gaussian roll-off turns the peak into a Gaussian of PHASE_PEAK_SIGMA
+    // pixels, whose apex a 3-point fit recovers, and drops the noisy high
+    // frequencies.
+    const float PHASE_PEAK_SIGMA = 1.0f;
+    vector<float> rollX(fw), rollY(fh);
+    for (int x = 0; x < fw; x++) {
+        float u = float(x < fw/2 ? x : x - fw) / fw;
+        rollX[x] = exp(-2*M_PI*M_PI*PHASE_PEAK_SIGMA*PHASE_PEAK_SIGMA*u*u);
+    }
+    for (int y = 0; y < fh; y++) {
+        float v = float(y < fh/2 ? y : y - fh) / fh;
+        rollY[y] = exp(-2*M_PI*M_PI*PHASE_PEAK_SIGMA*PHASE_PEAK_SIGMA*v*v);
+    }
+    #pragma omp parallel for
+    for (int y = 0; y < fh; y++) {
+        for (int x = 0; x < fw; x++) {
+            int i = x + fw*y;
+            float ar = f1[i].real(), ai = f1[i].imag();
+            float br = f2[i].real(), bi = f2[i].imag();
+            float cr = ar*br + ai*bi, ci = ai*br - ar*bi;
+            float mag = sqrt(cr*cr + ci*ci);
+            float s = mag > 1e-12f ? rollX[x]*rollY[y] / mag : 0.0f;
+            f1[i] = Complex(cr*s, ci*s);
+        }
+    }
+    fft2D(f1, fw, fh, true);
+
+    int peak = 0;
+    for (int i = 1; i < fw*fh; i++) {
+        if (f1[i].real() > f1[peak].real()) peak = i;
+    }
+    int px = peak % fw, py = peak / fw;
+    // sub-pixel apex from the neighbors, which wrap around like the shifts
+    float dx = gaussianPeak(f1[(px + fw - 1) % fw + fw*py].real(), f1[peak].real(), f1[(px + 1) % fw + fw*py].real());
+    float dy = gaussianPeak(f1[px + fw*((py + fh - 1) % fh)].real(), f1[peak].real(), f1[px + fw*((py + 1) % fh)].real());
+
+    // shifts past half the transform are negative
+    if (px > fw/2) px -= fw;
+    if (py > fh/2) py -= fh;
+    return vector<float> {px + dx, py + dy};
+}
+
+Image translate(const Image &im, float dx, float dy){
+    // same direction as roll: pixel (x, y) of im moves to (x+dx, y+dy).
+    // Bilinear, the borders are clamped instead of wrapping around.
+    Image output(im.width(), im.height(), im.channels());
+    int w = im.width(), h = im.height();
+    #pragma omp parallel for
+    for (int y = 0; y < h; y++) {
+        float sy = min(max(y - dy, 0.0f), float(h - 1));
+        int y0 = int(sy), y1 = min(y0 + 1, h - 1);
+        float ay = sy - y0;
+        for (int x = 0; x < w; x++) {
+            float sx = min(max(x - dx, 0.0f), float(w - 1));
+            int x0 = int(sx), x1 = min(x0 + 1, w - 1);
+            float ax = sx - x0;
+            for (int z = 0; z < im.channels(); z++) {
+                float top = im(x0, y0, z) + ax*(im(x1, y0, z) - im(x0, y0, z));
+                float bot = im(x0, y1, z) + ax*(im(x1, y1, z) - im(x0, y1, z));
+                output(x, y, z) = top + ay*(bot - top);
             }
         }
+    }
+    return output;
+}
 
+// im2 moved onto im1 with the given method
+static Image alignTo(const Image &im1, const Image &im2, int maxOffset, AlignMethod method){
+    if (method == ALIGN_PHASE_CORRELATION) {
+        vector<float> shift = alignPhaseCorrelation(im1, im2);
+        return translate(im2, shift[0], shift[1]);
+    }
+    vector<int> shift = align(im1, im2, maxOffset);
+    return roll(im2, shift[0], shift[1]);
+}
 
+// Frames 1..count-1, produced by frame(i), are aligned onto the reference
+// concurrently and added to the running mean in sequence order, as soon
+// as they are ready. Only the frames in flight are resident, about one
+// per thread, and the result does not depend on the number of threads.
+static Image alignAndAverage(const Image &reference, int count, const function<Image(int)> &frame,
+                             int maxOffset, AlignMethod method){
+    BurstStats stats;
+    stats.add(reference);
+
+    #pragma omp parallel for ordered schedule(dynamic)
+    for (int i = 1; i < count; i++) {
+        Image aligned = alignTo(reference, frame(i), maxOffset, method);
+        #pragma omp ordered
+        stats.add(aligned);
     }
-    return vector<int> {x,y};
+    return stats.mean();
 }
 
-Image alignAndDenoise(const vector<Image> &imSeq, int maxOffset){
+Image alignAndDenoise(const vector<Image> &imSeq, int maxOffset, AlignMethod method){
     // // --------- HANDOUT  PS03 ------------------------------
     // Registers all images to the first one in a sequence and outputs
     // a denoised image even when the input sequence is not perfectly aligned.
-    Image im1 = imSeq.at(0);
+    return alignAndAverage(imSeq.at(0), imSeq.size(),
+                           [&](int i) { return imSeq[i]; }, maxOffset, method);
+}
 
-    vector<Image> shifted_seq;
-    for (auto & im : imSeq){
-        std::vector<int> best_shift = align(im1, im);
-        Image shifted_image = roll(im, best_shift.at(0), best_shift.at(1));
-        shifted_seq.push_back(shifted_image);
-    }
-    
-    Image denoised_image = denoiseSeq(shifted_seq);
-    return denoised_image;
+Image alignAndDenoise(const vector<string> &filenames, int maxOffset, AlignMethod method){
+    Image reference(filenames.at(0));
+    return alignAndAverage(reference, filenames.size(),
+                           [&](int i) { return Image(filenames[i]); }, maxOffset, method);
 }
 
 Image split(const Image &sergeyImg){
@@ -178,7 +281,7 @@ Image split(const Image &sergeyImg){
     return reconstructedSergey;
 }
 
-Image sergeyRGB(const Image &sergeyImg, int maxOffset){
+Image sergeyRGB(const Image &sergeyImg, int maxOffset, AlignMethod method){
     // // --------- HANDOUT  PS03 ------------------------------
     // 6.865 only:
     // aligns the green and blue channels of your rgb channel of a sergey
@@ -195,11 +298,8 @@ Image sergeyRGB(const Image &sergeyImg, int maxOffset){
             sergeyBlue(a,b) = splitSergey(a,b,2);
         }
     }
-    vector<int> green_align = align(sergeyRed, sergeyGreen, maxOffset);
-    vector<int> blue_align = align(sergeyRed, sergeyBlue, maxOffset);
-
-    Image rolled_sergeyGreen = roll(sergeyGreen, green_align[0], green_align[1]);
-    Image rolled_sergeyBlue = roll(sergeyBlue, blue_align[0], blue_align[1]);
+    Image rolled_sergeyGreen = alignTo(sergeyRed, sergeyGreen, maxOffset, method);
+    Image rolled_sergeyBlue = alignTo(sergeyRed, sergeyBlue, maxOffset, method);
 
     Image sergeyAligned = splitSergey;
     for (int a = maxOffset; a < splitSergey.width() - maxOffset; a++){
@@ -14,6 +14,7 @@
 
 #include "Image.h"
 #include "basicImageManipulation.h"
+#include "burst.h"
 #include <iostream>
 #include <cmath>
 
@@ -21,10 +22,28 @@ using namespace std;
 
 Image denoiseSeq(const vector<Image> &imgs);
 Image logSNR(const vector<Image> &imSeq, float scale=1.0/20.0);
+// (x,y) roll of im2 that best matches im1, searched coarse-to-fine on a
+// pyramid. alignBruteForce tries every shift up to maxOffset.
 vector<int> align(const Image &im1, const Image &im2, int maxOffset=20);
-Image alignAndDenoise(const vector<Image> &imSeq, int maxOffset=20);
+vector<int> alignBruteForce(const Image &im1, const Image &im2, int maxOffset=20);
+
+// Sub-pixel (x,y) shift of im2 that best matches im1, from the peak of the
+// phase correlation. Any shift up to half the image size is found in
+// O(N log N).
+vector<float> alignPhaseCorrelation(const Image &im1, const Image &im2);
+// Bilinear shift by a fractional offset, in the direction of roll
+Image translate(const Image &im, float dx, float dy);
+
+enum AlignMethod {
+    ALIGN_SEARCH,            // integer shift from align, applied with roll
+    ALIGN_PHASE_CORRELATION  // sub-pixel shift, applied with translate
+};
+// Frames are aligned in parallel and averaged as they arrive. The file
+// version loads each frame when it is aligned.
+Image alignAndDenoise(const vector<Image> &imSeq, int maxOffset=20, AlignMethod method=ALIGN_SEARCH);
+Image alignAndDenoise(const vector<string> &filenames, int maxOffset=20, AlignMethod method=ALIGN_SEARCH);
 Image split(const Image &sergeyImg);
-Image sergeyRGB(const Image &sergeyImg, int maxOffset=20);
+Image sergeyRGB(const Image &sergeyImg, int maxOffset=20, AlignMethod method=ALIGN_SEARCH);
 Image roll(const Image &im, int xRoll, int yRoll); 
  
 #endif
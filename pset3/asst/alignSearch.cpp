@@ -0,0 +1,131 @@
+/* --------------------------------------------------------------------------
+ * File:    alignSearch.cpp
+ * Created: 2026-10-18
+ * --------------------------------------------------------------------------
+ *
+ * Pyramids and shift searches shared by the global and tile alignments
+ *
+ * ------------------------------------------------------------------------*/
+
+
+
+#include "alignSearch.h"
+#include <algorithm>
+
+using namespace std;
+
+AlignPlane toPlane(const Image &im, bool gray) {
+    AlignPlane p;
+    p.w = im.width();
+    p.h = im.height();
+    p.nc = gray ? 1 : im.channels();
+    p.data.assign(p.w*p.h*p.nc, 0.0f);
+    for (int z = 0; z < im.channels(); z++)
+    for (int y = 0; y < p.h; y++)
+    for (int x = 0; x < p.w; x++)
+    {
+        if (gray) p.data[x + p.w*y] += im(x, y, z) / im.channels();
+        else      p.data[x + p.w*(y + p.h*z)] = im(x, y, z);
+    }
+    return p;
+}
+
+AlignPlane halvePlane(const AlignPlane &p) {
+    AlignPlane q;
+    q.w = p.w / 2;
+    q.h = p.h / 2;
+    q.nc = p.nc;
+    q.data.resize(q.w*q.h*q.nc);
+    for (int z = 0; z < q.nc; z++)
+    for (int y = 0; y < q.h; y++)
+    {
+        const float *r0 = &p.data[p.w*(2*y + p.h*z)];
+        const float *r1 = r0 + p.w;
+        float *out = &q.data[q.w*(y + q.h*z)];
+        for (int x = 0; x < q.w; x++) {
+            out[x] = 0.25f * (r0[2*x] + r0[2*x+1] + r1[2*x] + r1[2*x+1]);
+        }
+    }
+    return q;
+}
+
+vector<AlignPlane> planePyramid(const AlignPlane &base, int levels) {
+    vector<AlignPlane> pyr(1, base);
+    for (int l = 1; l < levels; l++) pyr.push_back(halvePlane(pyr.back()));
+    return pyr;
+}
+
+float shiftedSSD(const AlignPlane &a, const AlignPlane &b, const AlignRect &rect, int dx, int dy, float bound) {
+    int x0 = max(rect.x0, 0), x1 = min(rect.x1, a.w);
+    int y0 = max(rect.y0, 0), y1 = min(rect.y1, a.h);
+    if (x0 >= x1 || y0 >= y1) return 0.0f;
+    int n = x1 - x0;
+    bool rowInside = (x0 - dx >= 0) && (x1 - dx <= b.w);
+    float total = 0.0f;
+    for (int z = 0; z < a.nc; z++)
+    for (int y = y0; y < y1; y++)
+    {
+        int by = min(max(y - dy, 0), b.h - 1);
+        const float *ra = &a.data[x0 + a.w*(y + a.h*z)];
+        const float *rowB = &b.data[b.w*(by + b.h*z)];
+        float row = 0.0f;
+        if (rowInside) {
+            const float *rb = rowB + x0 - dx;
+            for (int x = 0; x < n; x++) {
+                float d = rb[x] - ra[x];
+                row += d*d;
+            }
+        } else {
+            for (int x = 0; x < n; x++) {
+                float d = rowB[min(max(x0 + x - dx, 0), b.w - 1)] - ra[x];
+                row += d*d;
+            }
+        }
+        total += row;
+        if (total > bound) return total;
+    }
+    return total;
+}
+
+void searchWindow(const AlignPlane &a, const AlignPlane &b, const AlignRect &rect,
+                  int cx, int cy, int radius, int limit, bool parallel, int &bestX, int &bestY) {
+    int x0 = max(cx - radius, -limit), x1 = min(cx + radius, limit);
+    int y0 = max(cy - radius, -limit), y1 = min(cy + radius, limit);
+    int ny = y1 - y0 + 1;
+    int count = (x1 - x0 + 1) * ny;
+    vector<float> ssd(count);
+
+    #pragma omp parallel if(parallel)
+    {
+        float bound = FLT_MAX;
+        #pragma omp for schedule(dynamic)
+        for (int i = 0; i < count; i++) {
+            ssd[i] = shiftedSSD(a, b, rect, x0 + i / ny, y0 + i % ny, bound);
+            bound = min(bound, ssd[i]);
+        }
+    }
+
+    int best = 0;
+    for (int i = 1; i < count; i++) {
+        if (ssd[i] < ssd[best]) best = i;
+    }
+    bestX = x0 + best / ny;
+    bestY = y0 + best % ny;
+}
+
+void pyramidSearch(const vector<AlignPlane> &pa, const vector<AlignPlane> &pb,
+                   const vector<AlignRect> &rects, int maxOffset, bool parallel, int &x, int &y) {
+    const int ALIGN_REFINE_RADIUS = 1;
+    int top = int(pa.size()) - 1;
+    x = 0;
+    y = 0;
+    for (int l = top; l >= 0; l--) {
+        // largest shift at this level
+        int limit = (maxOffset + (1 << l) - 1) >> l;
+        if (l == top) {
+            searchWindow(pa[l], pb[l], rects[l], 0, 0, limit, limit, parallel, x, y);
+        } else {
+            searchWindow(pa[l], pb[l], rects[l], 2*x, 2*y, ALIGN_REFINE_RADIUS, limit, parallel, x, y);
+        }
+    }
+}
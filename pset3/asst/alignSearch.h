@@ -0,0 +1,59 @@
+/* --------------------------------------------------------------------------
+ * File:    alignSearch.h
+ * Created: 2026-10-18
+ * --------------------------------------------------------------------------
+ *
+ * Pyramids and shift searches shared by the global and tile alignments
+ *
+ * ------------------------------------------------------------------------*/
+
+
+
+#ifndef __alignSearch__h
+#define __alignSearch__h
+
+#include "Image.h"
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+// Planar float copy of an image for the alignment searches, x + w*(y + h*z)
+struct AlignPlane {
+    int w, h, nc;
+    vector<float> data;
+};
+
+// With gray set, a single plane holding the average of the channels
+AlignPlane toPlane(const Image &im, bool gray=false);
+// Next pyramid level, the average of 2x2 blocks
+AlignPlane halvePlane(const AlignPlane &p);
+// base and levels-1 successive halvings of it
+vector<AlignPlane> planePyramid(const AlignPlane &base, int levels);
+
+// Region [x0, x1) x [y0, y1) of the first plane compared by a search
+struct AlignRect {
+    int x0, y0, x1, y1;
+};
+
+// Squared error between a over rect and b rolled by (dx, dy): pixel (x, y)
+// of the roll is b(x-dx, y-dy), clamped to b. Rows that stay inside b are
+// read in place. Stops early, returning a value above bound, once the sum
+// exceeds bound.
+float shiftedSSD(const AlignPlane &a, const AlignPlane &b, const AlignRect &rect, int dx, int dy,
+                 float bound=FLT_MAX);
+
+// Best roll in the window of the given radius around (cx, cy), with rolls
+// limited to [-limit, limit]. Ties go to the first roll in x-major order.
+// With parallel set, the candidates are split between threads.
+void searchWindow(const AlignPlane &a, const AlignPlane &b, const AlignRect &rect,
+                  int cx, int cy, int radius, int limit, bool parallel, int &bestX, int &bestY);
+
+// Coarse-to-fine roll of pb that best matches pa, up to maxOffset: the full
+// search only runs on the coarsest level, every finer level refines twice
+// the roll found below it within +-1. rects[l] is the region compared on
+// level l.
+void pyramidSearch(const vector<AlignPlane> &pa, const vector<AlignPlane> &pb,
+                   const vector<AlignRect> &rects, int maxOffset, bool parallel, int &x, int &y);
+
+#endif
@@ -0,0 +1,218 @@
+/* --------------------------------------------------------------------------
+ * File:    burst.cpp
+ * Created: 2026-10-18
+ * --------------------------------------------------------------------------
+ *
+ * Burst processing with a bounded number of frames in memory
+ *
+ * ------------------------------------------------------------------------*/
+
+
+
+#include "burst.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+BurstStats::BurstStats() : n(0), w(0), h(0), nc(0) {}
+
+void BurstStats::add(const Image &frame) {
+    if (n == 0) {
+        w = frame.width();
+        h = frame.height();
+        nc = frame.channels();
+        mu.assign(w*h*nc, 0.0f);
+        m2.assign(w*h*nc, 0.0f);
+    } else if (frame.width() != w || frame.height() != h || frame.channels() != nc) {
+        throw MismatchedDimensionsException();
+    }
+    n++;
+
+    float invN = 1.0f / n;
+    int size = w*h*nc;
+    #pragma omp parallel for
+    for (int i = 0; i < size; i++) {
+        float x = frame(i);
+        float delta = x - mu[i];
+        mu[i] += delta * invN;
+        m2[i] += delta * (x - mu[i]);
+    }
+}
+
+void BurstStats::add(const string &filename) {
+    add(Image(filename));
+}
+
+Image BurstStats::fromBuffer(const vector<float> &buffer) const {
+    if (n == 0)
+        throw InvalidArgument();
+    Image output(w, h, nc);
+    for (int i = 0; i < w*h*nc; i++) output(i) = buffer[i];
+    return output;
+}
+
+Image BurstStats::mean() const {
+    return fromBuffer(mu);
+}
+
+Image BurstStats::variance() const {
+    vector<float> var(m2.size());
+    for (int i = 0; i < (int)var.size(); i++) {
+        var[i] = n > 1 ? m2[i] / (n - 1) : 0.0f;
+        if (var[i] == 0) var[i] = 0.000000001;
+    }
+    return fromBuffer(var);
+}
+
+Image BurstStats::meanSquare() const {
+    vector<float> sq(m2.size());
+    for (int i = 0; i < (int)sq.size(); i++) {
+        sq[i] = mu[i]*mu[i] + m2[i] / n;
+    }
+    return fromBuffer(sq);
+}
+
+Image BurstStats::logSNR(float scale) const {
+    Image sq = meanSquare();
+    Image var = variance();
+    Image output(w, h, nc);
+    for (int i = 0; i < w*h*nc; i++) {
+        output(i) = 10*log10(sq(i) / var(i)) * scale;
+    }
+    return output;
+}
+
+BurstStats burstStats(const vector<string> &filenames) {
+    BurstStats stats;
+    for (const string &f : filenames) stats.add(f);
+    return stats;
+}
+
+
+TileMerger::TileMerger(const Image &reference_, int tileSize, int maxOffset_, float noiseSigma)
+    : w(reference_.width()), h(reference_.height()), nc(reference_.channels()),
+      tile(max(2*(tileSize/2), 2)), maxOffset(maxOffset_), levels(1), n(0), sigma(noiseSigma),
+      reference(reference_)
+{
+    // coarse levels while the search still spans a few pixels and the
+    // tiles keep a few pixels
+    while ((maxOffset >> levels) >= 2 && (tile >> levels) >= 4
+            && (w >> levels) >= 8 && (h >> levels) >= 8) levels++;
+    refPyramid = planePyramid(toPlane(reference, true), levels);
+
+    if (sigma < 0) {
+        // robust estimate from the horizontal differences of the
+        // reference: median |d| * 1.4826 / sqrt(2)
+        vector<float> diffs;
+        for (int z = 0; z < nc; z++)
+        for (int y = 0; y < h; y++)
+        for (int x = 0; x + 1 < w; x++)
+            diffs.push_back(fabs(reference(x+1, y, z) - reference(x, y, z)));
+        nth_element(diffs.begin(), diffs.begin() + diffs.size()/2, diffs.end());
+        sigma = diffs.empty() ? 0.0f : diffs[diffs.size()/2] * 1.4826f / sqrt(2.0f);
+    }
+
+    window.resize(tile);
+    for (int i = 0; i < tile; i++) window[i] = 0.5f - 0.5f*cos(2*M_PI*(i + 0.5f)/tile);
+
+    acc.assign(w*h*nc, 0.0f);
+    weight.assign(w*h, 0.0f);
+    // the reference is a frame of the merge that matches itself exactly
+    accumulate(reference, refPyramid);
+}
+
+void TileMerger::accumulate(const Image &frame, const vector<AlignPlane> &pyramid) {
+    int half = tile / 2;
+    // tiles start half a tile before the image so that every pixel is
+    // covered by windows summing to one
+    int nx = (w + half - 1) / half + 1, ny = (h + half - 1) / half + 1;
+    float noiseVar = sigma*sigma;
+    bool isReference = (&pyramid == &refPyramid);
+
+    // tiles of the same parity do not overlap, each phase runs in parallel
+    for (int phase = 0; phase < 4; phase++) {
+        #pragma omp parallel for schedule(dynamic)
+        for (int t = 0; t < nx*ny; t++) {
+            int tx = t % nx, ty = t / nx;
+            if ((tx % 2) != (phase % 2) || (ty % 2) != (phase / 2)) continue;
+            int x0 = tx*half - half, y0 = ty*half - half;
+
+            // coarse-to-fine displacement of this tile: the frame pixel
+            // (x + dx, y + dy) matches the reference pixel (x, y), a roll
+            // by (-dx, -dy). The tiles are already spread over the threads.
+            int dx = 0, dy = 0;
+            if (!isReference) {
+                vector<AlignRect> rects;
+                for (int l = 0; l < levels; l++) {
+                    rects.push_back(AlignRect {x0 >> l, y0 >> l, (x0 >> l) + (tile >> l), (y0 >> l) + (tile >> l)});
+                }
+                int rollX, rollY;
+                pyramidSearch(refPyramid, pyramid, rects, maxOffset, false, rollX, rollY);
+                dx = -rollX;
+                dy = -rollY;
+            }
+
+            // robust weight from the mean squared difference left after
+            // alignment, the difference of two frames has twice the noise
+            float tileWeight = 1.0f;
+            if (!isReference) {
+                float d = 0.0f;
+                int count = 0;
+                for (int z = 0; z < nc; z++)
+                for (int y = max(y0, 0); y < min(y0 + tile, h); y++)
+                for (int x = max(x0, 0); x < min(x0 + tile, w); x++)
+                {
+                    int fx = min(max(x + dx, 0), w - 1), fy = min(max(y + dy, 0), h - 1);
+                    float diff = frame(fx, fy, z) - reference(x, y, z);
+                    d += diff*diff;
+                    count++;
+                }
+                d = count ? d / count : 0.0f;
+                float excess = max(d - 2*noiseVar, 0.0f);
+                tileWeight = (2*noiseVar + 1e-12f) / (2*noiseVar + excess + 1e-12f);
+            }
+
+            for (int y = max(y0, 0); y < min(y0 + tile, h); y++) {
+                int fy = min(max(y + dy, 0), h - 1);
+                for (int x = max(x0, 0); x < min(x0 + tile, w); x++) {
+                    int fx = min(max(x + dx, 0), w - 1);
+                    float wgt = tileWeight * window[x - x0] * window[y - y0];
+                    weight[x + w*y] += wgt;
+                    for (int z = 0; z < nc; z++) {
+                        acc[x + w*(y + h*z)] += wgt * frame(fx, fy, z);
+                    }
+                }
+            }
+        }
+    }
+    n++;
+}
+
+void TileMerger::add(const Image &frame) {
+    if (frame.width() != w || frame.height() != h || frame.channels() != nc)
+        throw MismatchedDimensionsException();
+    accumulate(frame, planePyramid(toPlane(frame, true), levels));
+}
+
+void TileMerger::add(const string &filename) {
+    add(Image(filename));
+}
+
+Image TileMerger::result() const {
+    Image output(w, h, nc);
+    for (int z = 0; z < nc; z++)
+    for (int y = 0; y < h; y++)
+    for (int x = 0; x < w; x++)
+    {
+        float wsum = weight[x + w*y];
+        output(x, y, z) = wsum > 0 ? acc[x + w*(y + h*z)] / wsum : reference(x, y, z);
+    }
+    return output;
+}
+
+Image mergeBurst(const vector<Image> &imSeq, int tileSize, int maxOffset, float noiseSigma) {
+    TileMerger merger(imSeq.at(0), tileSize, maxOffset, noiseSigma);
+    for (int i = 1; i < (int)imSeq.size(); i++) merger.add(imSeq[i]);
+    return merger.result();
+}
@@ -0,0 +1,91 @@
+/* --------------------------------------------------------------------------
+ * File:    burst.h
+ * Created: 2026-10-18
+ * --------------------------------------------------------------------------
+ *
+ * Burst processing with a bounded number of frames in memory
+ *
+ * ------------------------------------------------------------------------*/
+
+
+
+#ifndef __burst__h
+#define __burst__h
+
+#include "Image.h"
+#include "alignSearch.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Per-pixel mean and variance of a burst, updated one frame at a time
+// with Welford's recurrence. Only the running mean and sum of squared
+// deviations are kept, whatever the number of frames.
+class BurstStats {
+public:
+    BurstStats();
+
+    void add(const Image &frame);
+    // Loads the frame, adds it and releases it
+    void add(const string &filename);
+
+    int count() const { return n; }
+    Image mean() const;
+    // Unbiased variance (divided by count-1), zeros replaced by 1e-9 so
+    // that it can be divided by
+    Image variance() const;
+    // E[x^2] = mean^2 + the biased variance
+    Image meanSquare() const;
+    // 10 log10(E[x^2] / variance) * scale
+    Image logSNR(float scale=1.0/20.0) const;
+
+private:
+    int n, w, h, nc;
+    vector<float> mu, m2;
+
+    Image fromBuffer(const vector<float> &buffer) const;
+};
+
+// Statistics of the frames stored in the given files, loaded one by one
+BurstStats burstStats(const vector<string> &filenames);
+
+
+// Tile-based merge of a burst onto a reference frame. Every frame is cut
+// into tiles of tileSize pixels overlapping by half, and each tile is
+// aligned on its own, coarse-to-fine, within maxOffset. A tile is then
+// weighted by how well it matches the reference: a difference at the
+// noise level counts fully, larger differences (motion the alignment
+// could not follow, occlusions) fade out. Tiles are blended with raised
+// cosine windows, which sum to one over the overlaps.
+//
+// noiseSigma is the noise standard deviation of a frame, estimated from
+// the reference when negative. Only the reference, the accumulators and
+// the current frame are kept.
+class TileMerger {
+public:
+    TileMerger(const Image &reference, int tileSize=16, int maxOffset=8, float noiseSigma=-1);
+
+    void add(const Image &frame);
+    void add(const string &filename);
+
+    int count() const { return n; }
+    float noise() const { return sigma; }
+    Image result() const;
+
+private:
+    int w, h, nc, tile, maxOffset, levels, n;
+    float sigma;
+    Image reference;
+    vector<AlignPlane> refPyramid;  // channel averages
+    vector<float> window;      // 1D raised cosine of the tiles
+    vector<float> acc, weight; // weighted sums of the samples and weights
+
+    void accumulate(const Image &frame, const vector<AlignPlane> &pyramid);
+};
+
+// Merge of imSeq onto its first frame
+Image mergeBurst(const vector<Image> &imSeq, int tileSize=16, int maxOffset=8, float noiseSigma=-1);
+
+#endif
@@ -9,7 +9,9 @@
 
 
 #include "demosaic.h"
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 using namespace std;
 
@@ -171,11 +173,128 @@ Image greenBasedRorB(const Image &raw, Image &green, int offsetX, int offsetY){
     return greenBasedRorB_im;
 }
 
+// Rows of output per parallel band of the fused demosaic
+static const int DEMOSAIC_BAND = 32;
+
+// Raw minus green at offset (dx, dy) of the current pixel
+static inline float chromaDiff(const float *r, const float *g, int stride, int dx, int dy) {
+    return r[dx + dy*stride] - g[dx + dy*stride];
+}
+
+// One output pixel of improvedDemosaic at a site of parity (SX, SY), red at
+// (RX, RY). The site type is known at compile time, so the tests below fold
+// away and every pixel of a 2x2 quad is a fixed expression. r and g point at
+// the pixel in the raw and green planes, whose rows are stride apart. The
+// arithmetic matches the separate passes, (raw - green) + green included.
+template <int SX, int SY, int RX, int RY>
+static inline void demosaicPixel(const float *r, const float *g, int stride, Image &output, int x, int y) {
+    const int cx[2] = {RX, 1 - RX}, cy[2] = {RY, 1 - RY};
+    float green = g[0];
+    float chroma[2];
+    for (int c = 0; c < 2; c++) {
+        float d;
+        if (SX == cx[c] && SY == cy[c]) {
+            d = chromaDiff(r, g, stride, 0, 0);
+        } else if (SX == cx[c]) {
+            d = (chromaDiff(r, g, stride, 0, -1) + chromaDiff(r, g, stride, 0, 1))/2.0;
+        } else if (SY == cy[c]) {
+            d = (chromaDiff(r, g, stride, -1, 0) + chromaDiff(r, g, stride, 1, 0))/2.0;
+        } else {
+            d = (chromaDiff(r, g, stride, -1, -1) + chromaDiff(r, g, stride, -1, 1)
+                 + chromaDiff(r, g, stride, 1, -1) + chromaDiff(r, g, stride, 1, 1))/4.0;
+        }
+        chroma[c] = d + green;
+    }
+    output(x, y, 0) = chroma[0];
+    output(x, y, 1) = green;
+    output(x, y, 2) = chroma[1];
+}
+
+// Green of edgeBasedGreen at a site known to be green or not
+template <bool IS_GREEN>
+static inline float greenAt(const float *r, int stride) {
+    if (IS_GREEN) return r[0];
+    float row_diff = fabs(r[-1] - r[1]);
+    float col_diff = fabs(r[-stride] - r[stride]);
+    if (col_diff < row_diff) return (r[-stride] + r[stride])/2.0;
+    return (r[-1] + r[1])/2.0;
+}
+
+// Interior of a green row, y of parity SY. Columns go in (odd, even) pairs
+// from x = 1 so that both site types are fixed.
+template <int SY, int RX, int RY>
+static void greenRow(const float *r, float *g, int w) {
+    const bool ODD_GREEN = ((1 + SY) % 2) != ((RX + RY) % 2);
+    const bool EVEN_GREEN = !ODD_GREEN;
+    for (int x = 1; x < w - 1; x += 2) {
+        g[x] = greenAt<ODD_GREEN>(r + x, w);
+        if (x + 1 < w - 1) g[x + 1] = greenAt<EVEN_GREEN>(r + x + 1, w);
+    }
+}
+
+template <int SY, int RX, int RY>
+static void colorRow(const float *r, const float *g, int w, Image &output, int y) {
+    for (int x = 1; x < w - 1; x += 2) {
+        demosaicPixel<1, SY, RX, RY>(r + x, g + x, w, output, x, y);
+        if (x + 1 < w - 1) demosaicPixel<0, SY, RX, RY>(r + x + 1, g + x + 1, w, output, x + 1, y);
+    }
+}
+
+template <int RX, int RY>
+static Image demosaicBayer(const Image &raw) {
+    int w = raw.width(), h = raw.height();
+    Image output(w, h, 3);
+    if (w < 3 || h < 3) return output;
+
+    vector<float> plane(w*h);
+    for (int y = 0; y < h; y++)
+    for (int x = 0; x < w; x++)
+        plane[x + w*y] = raw(x, y);
+
+    int nBands = (h - 2 + DEMOSAIC_BAND - 1) / DEMOSAIC_BAND;
+    #pragma omp parallel for schedule(dynamic)
+    for (int band = 0; band < nBands; band++) {
+        // green of rows y0-1 .. y1, the rows the band reads, zero on the
+        // image border like edgeBasedGreen
+        int y0 = 1 + band*DEMOSAIC_BAND, y1 = min(y0 + DEMOSAIC_BAND, h - 1);
+        int gy0 = y0 - 1;
+        vector<float> green(w*(y1 + 1 - gy0), 0.0f);
+        for (int y = max(gy0, 1); y <= min(y1, h - 2); y++) {
+            if (y % 2 == 0) greenRow<0, RX, RY>(&plane[w*y], &green[w*(y - gy0)], w);
+            else            greenRow<1, RX, RY>(&plane[w*y], &green[w*(y - gy0)], w);
+        }
+
+        for (int y = y0; y < y1; y++) {
+            if (y % 2 == 0) colorRow<0, RX, RY>(&plane[w*y], &green[w*(y - gy0)], w, output, y);
+            else            colorRow<1, RX, RY>(&plane[w*y], &green[w*(y - gy0)], w, output, y);
+        }
+    }
+    return output;
+}
+
+Image improvedDemosaic(const Image &raw, BayerPattern pattern){
+    switch (pattern) {
+        case BAYER_RGGB: return demosaicBayer<0, 0>(raw);
+        case BAYER_BGGR: return demosaicBayer<1, 1>(raw);
+        case BAYER_GRBG: return demosaicBayer<1, 0>(raw);
+        default:         return demosaicBayer<0, 1>(raw);
+    }
+}
+
 Image improvedDemosaic(const Image &raw, int offsetGreen, int offsetRedX, int offsetRedY, int offsetBlueX, int offsetBlueY){
     // --------- HANDOUT  PS03 ------------------------------
     // Takes as input a raw image and returns an rgb image
     // using edge-based green demosaicing for the green channel and
     // simple green based demosaicing of the red and blue channels
+    // Offsets that describe a Bayer layout go through the fused kernel
+    bool bayer = offsetRedX >= 0 && offsetRedX <= 1 && offsetRedY >= 0 && offsetRedY <= 1
+        && offsetBlueX == 1 - offsetRedX && offsetBlueY == 1 - offsetRedY
+        && ((offsetRedX + offsetRedY) % 2 == 1) == (offsetGreen % 2 == 0);
+    if (bayer) {
+        const BayerPattern patterns[2][2] = {{BAYER_RGGB, BAYER_GBRG}, {BAYER_GRBG, BAYER_BGGR}};
+        return improvedDemosaic(raw, patterns[offsetRedX][offsetRedY]);
+    }
+
     std::cout << "in edge based green demosaic" << std::endl;
     Image output(raw.width(), raw.height(), 3);
     Image green = edgeBasedGreen(raw, offsetGreen);
@@ -27,5 +27,19 @@ Image edgeBasedGreenDemosaic(const Image &raw, int offsetGreen=0, int offsetRedX
 Image greenBasedRorB(const Image &raw, Image &green, int offsetX, int offsetY);
 Image improvedDemosaic(const Image &raw, int offsetGreen=0, int offsetRedX=1, int offsetRedY=1, int offsetBlueX=0, int offsetBlueY=0);
 
+// CFA layouts, named by the colors of the 2x2 quad at (0,0), (1,0), (0,1),
+// (1,1). The offsets (1, 1,1, 0,0) used for the signs are BGGR.
+enum BayerPattern {
+    BAYER_RGGB,
+    BAYER_BGGR,
+    BAYER_GRBG,
+    BAYER_GBRG
+};
+// Same result as improvedDemosaic with the matching offsets, in a single
+// pass: green, red and blue are computed together, row band by row band,
+// by a kernel specialized at compile time for the layout. improvedDemosaic
+// uses it whenever its offsets describe a Bayer layout.
+Image improvedDemosaic(const Image &raw, BayerPattern pattern);
+
  
 #endif
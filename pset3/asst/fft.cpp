@@ -0,0 +1,117 @@
+/* --------------------------------------------------------------------------
+ * File:    fft.cpp
+ * Created: 2026-10-18
+ * --------------------------------------------------------------------------
+ *
+ * Radix-2 fast Fourier transforms, 1D and 2D
+ *
+ * ------------------------------------------------------------------------*/
+
+
+
+#include "fft.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+int nextPow2(int n) {
+    int p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+// Bit reversal permutation and twiddles e^(-2 pi i k/n), k < n/2, shared by
+// every transform of the same size
+struct FFTPlan {
+    int n;
+    vector<int> rev;
+    vector<float> twRe, twIm;
+};
+
+static FFTPlan makePlan(int n) {
+    if (n < 1 || (n & (n - 1)))
+        throw InvalidArgument();
+    FFTPlan plan;
+    plan.n = n;
+    plan.rev.resize(n);
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        plan.rev[i] = j;
+    }
+    plan.twRe.resize(max(n/2, 1));
+    plan.twIm.resize(max(n/2, 1));
+    for (int k = 0; k < n/2; k++) {
+        plan.twRe[k] = cos(-2.0 * M_PI * k / n);
+        plan.twIm[k] = sin(-2.0 * M_PI * k / n);
+    }
+    return plan;
+}
+
+// Iterative radix-2 transform of n interleaved (re, im) pairs
+static void runPlan(const FFTPlan &plan, float *d, bool inverse) {
+    int n = plan.n;
+    for (int i = 1; i < n; i++) {
+        int j = plan.rev[i];
+        if (i < j) {
+            swap(d[2*i], d[2*j]);
+            swap(d[2*i+1], d[2*j+1]);
+        }
+    }
+    float sign = inverse ? -1.0f : 1.0f;
+    for (int len = 2; len <= n; len <<= 1) {
+        int half = len / 2, stride = n / len;
+        for (int k = 0; k < half; k++) {
+            float wr = plan.twRe[k*stride], wi = sign * plan.twIm[k*stride];
+            for (int i = k; i < n; i += len) {
+                float *u = d + 2*i, *v = d + 2*(i + half);
+                float vr = v[0]*wr - v[1]*wi;
+                float vi = v[0]*wi + v[1]*wr;
+                v[0] = u[0] - vr;
+                v[1] = u[1] - vi;
+                u[0] += vr;
+                u[1] += vi;
+            }
+        }
+    }
+    if (inverse) {
+        float scale = 1.0f / n;
+        for (int i = 0; i < 2*n; i++) d[i] *= scale;
+    }
+}
+
+void fft(vector<Complex> &data, bool inverse) {
+    FFTPlan plan = makePlan(data.size());
+    runPlan(plan, reinterpret_cast<float *>(&data[0]), inverse);
+}
+
+void fft2D(vector<Complex> &data, int w, int h, bool inverse) {
+    if ((int)data.size() != w*h)
+        throw MismatchedDimensionsException();
+    FFTPlan rowPlan = makePlan(w), colPlan = makePlan(h);
+    float *d = reinterpret_cast<float *>(&data[0]);
+
+    #pragma omp parallel
+    {
+        // rows are contiguous, columns go through a buffer
+        #pragma omp for
+        for (int y = 0; y < h; y++) {
+            runPlan(rowPlan, d + 2*w*y, inverse);
+        }
+        vector<float> column(2*h);
+        #pragma omp for
+        for (int x = 0; x < w; x++) {
+            for (int y = 0; y < h; y++) {
+                column[2*y]   = d[2*(x + w*y)];
+                column[2*y+1] = d[2*(x + w*y) + 1];
+            }
+            runPlan(colPlan, &column[0], inverse);
+            for (int y = 0; y < h; y++) {
+                d[2*(x + w*y)]     = column[2*y];
+                d[2*(x + w*y) + 1] = column[2*y+1];
+            }
+        }
+    }
+}
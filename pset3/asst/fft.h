@@ -0,0 +1,35 @@
+/* --------------------------------------------------------------------------
+ * File:    fft.h
+ * Created: 2026-10-18
+ * --------------------------------------------------------------------------
+ *
+ * Radix-2 fast Fourier transforms, 1D and 2D
+ *
+ * ------------------------------------------------------------------------*/
+
+
+
+#ifndef __fft__h
+#define __fft__h
+
+#include "Image.h"
+#include <complex>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+typedef complex<float> Complex;
+
+// Smallest power of two >= n
+int nextPow2(int n);
+
+// In-place transform of a power of two number of samples. The inverse is
+// scaled by 1/n so that a forward and an inverse transform round trip.
+void fft(vector<Complex> &data, bool inverse=false);
+
+// In-place transform of a w x h array stored row by row (x + w*y), both
+// sizes powers of two. Rows and columns are transformed in parallel.
+void fft2D(vector<Complex> &data, int w, int h, bool inverse=false);
+
+#endif
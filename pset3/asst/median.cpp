@@ -0,0 +1,182 @@
+/* --------------------------------------------------------------------------
+ * File:    median.cpp
+ * Created: 2026-10-18
+ * --------------------------------------------------------------------------
+ *
+ * Constant-time median and percentile filters
+ *
+ * ------------------------------------------------------------------------*/
+
+
+
+#include "median.h"
+#include <algorithm>
+
+using namespace std;
+
+// width of the column strips processed independently (one per thread)
+static const int MEDIAN_TILE_WIDTH = 128;
+
+static inline int clampIndex(int i, int n) {
+    return i < 0 ? 0 : (i >= n ? n-1 : i);
+}
+
+// Percentile of one quantized channel over the output columns [x0, x1).
+// Every (padded) column keeps a histogram of its 2*radius+1 pixels, split in
+// a coarse level (the high bits) and a fine level. The kernel coarse
+// histogram slides along the row with one add and one subtract per bin; a
+// fine bucket is only brought up to date when the search lands in it.
+static void percentileStrip(const vector<int> &q, int w, int h, int x0, int x1,
+        int radius, int rank, int fineBits, int coarseBins, Image &out, int z, float scale)
+{
+    int C = coarseBins;
+    int F = 1 << fineBits;
+    int d = 2*radius + 1;
+    int ncols = (x1 - x0) + 2*radius;
+
+    // source column of every padded column, borders are clamped
+    vector<int> src(ncols);
+    for (int p = 0; p < ncols; p++) {
+        src[p] = clampIndex(x0 - radius + p, w);
+    }
+
+    vector<unsigned short> colCoarse(ncols*C, 0);
+    vector<unsigned short> colFine(ncols*C*F, 0);
+    vector<unsigned int> kCoarse(C), kFine(C*F);
+    vector<int> lastUpdate(C);
+
+    for (int y = 0; y < h; y++) {
+        // slide the column histograms down one row
+        for (int p = 0; p < ncols; p++) {
+            if (y == 0) {
+                for (int dy = -radius; dy <= radius; dy++) {
+                    int v = q[clampIndex(dy, h)*w + src[p]];
+                    colCoarse[p*C + (v >> fineBits)]++;
+                    colFine[p*C*F + v]++;
+                }
+            } else {
+                int vOut = q[clampIndex(y-radius-1, h)*w + src[p]];
+                int vIn  = q[clampIndex(y+radius, h)*w + src[p]];
+                colCoarse[p*C + (vOut >> fineBits)]--;
+                colFine[p*C*F + vOut]--;
+                colCoarse[p*C + (vIn >> fineBits)]++;
+                colFine[p*C*F + vIn]++;
+            }
+        }
+
+        // kernel histogram of the first window of the row, fine buckets are
+        // marked stale
+        fill(kCoarse.begin(), kCoarse.end(), 0);
+        for (int p = 0; p < d; p++)
+        for (int c = 0; c < C; c++)
+            kCoarse[c] += colCoarse[p*C + c];
+        fill(lastUpdate.begin(), lastUpdate.end(), -d);
+
+        for (int i = 0; i < x1 - x0; i++) {
+            // the window covers the padded columns i .. i+2*radius
+            if (i > 0) {
+                for (int c = 0; c < C; c++) {
+                    kCoarse[c] += colCoarse[(i+d-1)*C + c];
+                    kCoarse[c] -= colCoarse[(i-1)*C + c];
+                }
+            }
+
+            // coarse bucket holding the rank
+            unsigned int cum = 0;
+            int c = 0;
+            while (cum + kCoarse[c] <= (unsigned int)rank) {
+                cum += kCoarse[c];
+                c++;
+            }
+
+            // update its fine histogram, incrementally when it was used
+            // recently and from scratch otherwise
+            unsigned int *kf = &kFine[c*F];
+            if (i - lastUpdate[c] >= d) {
+                fill(kf, kf + F, 0);
+                for (int p = i; p < i+d; p++) {
+                    const unsigned short *cf = &colFine[(p*C + c)*F];
+                    for (int f = 0; f < F; f++) kf[f] += cf[f];
+                }
+            } else {
+                for (int j = lastUpdate[c]+1; j <= i; j++) {
+                    const unsigned short *cfIn  = &colFine[((j+d-1)*C + c)*F];
+                    const unsigned short *cfOut = &colFine[((j-1)*C + c)*F];
+                    for (int f = 0; f < F; f++) kf[f] += cfIn[f] - cfOut[f];
+                }
+            }
+            lastUpdate[c] = i;
+
+            int f = 0;
+            while (cum + kf[f] <= (unsigned int)rank) {
+                cum += kf[f];
+                f++;
+            }
+
+            out(x0+i, y, z) = (c*F + f) * scale;
+        }
+    }
+}
+
+
+Image percentileFilter(const Image &im, int radius, float percentile, int bits) {
+    int w = im.width(), h = im.height();
+    int levels = 1 << bits;
+    int fineBits = bits - bits/2;
+    int coarseBins = 1 << (bits/2);
+    int d = 2*radius + 1;
+    int rank = int(percentile*(d*d - 1) + 0.5f);
+    float scale = 1.0f / (levels - 1);
+
+    Image out(w, h, im.channels());
+    vector<int> q(w*h);
+    int nTiles = (w + MEDIAN_TILE_WIDTH - 1) / MEDIAN_TILE_WIDTH;
+
+    for (int z = 0; z < im.channels(); z++) {
+        // quantize the channel over [0, 1]
+        for (int y = 0; y < h; y++)
+        for (int x = 0; x < w; x++)
+        {
+            float v = min(max(im(x,y,z), 0.0f), 1.0f);
+            q[y*w + x] = int(v*(levels-1) + 0.5f);
+        }
+
+        #pragma omp parallel for schedule(dynamic)
+        for (int t = 0; t < nTiles; t++) {
+            int x0 = t*MEDIAN_TILE_WIDTH;
+            int x1 = min(x0 + MEDIAN_TILE_WIDTH, w);
+            percentileStrip(q, w, h, x0, x1, radius, rank, fineBits, coarseBins, out, z, scale);
+        }
+    }
+    return out;
+}
+
+Image medianFilter(const Image &im, int radius, int bits) {
+    return percentileFilter(im, radius, 0.5f, bits);
+}
+
+
+Image temporalPercentile(const vector<Image> &imSeq, float percentile) {
+    const Image &first = imSeq.at(0);
+    int n = imSeq.size();
+    int rank = int(percentile*(n - 1) + 0.5f);
+    Image out(first.width(), first.height(), first.channels());
+
+    // rows are independent
+    #pragma omp parallel for
+    for (int y = 0; y < first.height(); y++) {
+        vector<float> values(n);
+        for (int z = 0; z < first.channels(); z++)
+        for (int x = 0; x < first.width(); x++)
+        {
+            for (int i = 0; i < n; i++) values[i] = imSeq[i](x,y,z);
+            nth_element(values.begin(), values.begin() + rank, values.end());
+            out(x,y,z) = values[rank];
+        }
+    }
+    return out;
+}
+
+Image temporalMedian(const vector<Image> &imSeq) {
+    return temporalPercentile(imSeq, 0.5f);
+}
@@ -0,0 +1,32 @@
+/* --------------------------------------------------------------------------
+ * File:    median.h
+ * Created: 2026-10-18
+ * --------------------------------------------------------------------------
+ *
+ * Constant-time median and percentile filters
+ *
+ * ------------------------------------------------------------------------*/
+
+
+
+#ifndef __median__h
+#define __median__h
+
+#include "Image.h"
+#include <iostream>
+#include <cmath>
+
+using namespace std;
+
+// Spatial percentile over a (2*radius+1)^2 window with clamped borders.
+// Values are quantized to 2^bits levels over [0, 1] (bits is 8 or 16), and
+// the histogram-based filter (Perreault & Hebert 2007) costs O(1) per pixel
+// in the radius. percentile is in [0, 1], 0.5 being the median.
+Image percentileFilter(const Image &im, int radius, float percentile, int bits=8);
+Image medianFilter(const Image &im, int radius, int bits=8);
+
+// Per pixel and per channel percentile across a sequence of images
+Image temporalPercentile(const vector<Image> &imSeq, float percentile);
+Image temporalMedian(const vector<Image> &imSeq);
+
+#endif
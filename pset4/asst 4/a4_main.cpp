@@ -12,6 +12,10 @@
 #include "Image.h"
 #include "basicImageManipulation.h"
 #include "hdr.h"
+#include "filtering.h"
+#include "colorTransform.h"
+#include <cstdlib>
+#include <chrono>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
@@ -180,6 +184,216 @@ void testToneMapping_design() {
     // necessary to attempt this for testing
 }
 
+// Noisy step edge used to compare the fast filters against brute force
+Image noisyStepImage(int w, int h, int c, float noise=0.05) {
+    srand(0);
+    Image im(w, h, c);
+    for (int z = 0; z < c; z++)
+    for (int y = 0; y < h; y++)
+    for (int x = 0; x < w; x++)
+    {
+        float base = (x < w/2) ? 0.2f + 0.1f*z : 0.8f - 0.1f*z;
+        im(x,y,z) = base + 0.3f*y/h + noise*(2.0f*rand()/RAND_MAX - 1.0f);
+    }
+    return im;
+}
+
+// root mean square difference between two images
+float rmsError(const Image &im1, const Image &im2) {
+    double sum = 0.0;
+    for (int i = 0; i < im1.number_of_elements(); i++) {
+        sum += (im1(i) - im2(i))*(im1(i) - im2(i));
+    }
+    return sqrt(sum / im1.number_of_elements());
+}
+
+// Accuracy of the bilateral grid against the brute force bilateral filter
+void testBilateralGrid() {
+    Image gray = noisyStepImage(96, 96, 1);
+    Image ref  = bilateral(gray, 0.1, 2.0);
+    Image fast = bilateral(gray, 0.1, 2.0, 3.0, true, true);
+    cout << "bilateral grid (gray) rms error: " << rmsError(ref, fast) << endl;
+    fast.write("./Output/bilateralGrid-gray.png");
+
+    Image color = noisyStepImage(96, 96, 3);
+    ref  = bilaYUV(color, 0.1, 1.0, 3.0);
+    fast = bilaYUV(color, 0.1, 1.0, 3.0, 3.0, true, true);
+    cout << "bilateral grid (bilaYUV) rms error: " << rmsError(ref, fast) << endl;
+    fast.write("./Output/bilateralGrid-yuv.png");
+}
+
+// Tone mapping with the grid base should follow the exact bilateral base,
+// also on inputs with black pixels (log10 of zero) and a non-finite guide
+void testToneMapGrid() {
+    Image hdr(64, 48, 3);
+    for (int y = 0; y < hdr.height(); y++)
+    for (int x = 0; x < hdr.width(); x++)
+    for (int z = 0; z < hdr.channels(); z++)
+    {
+        hdr(x,y,z) = (x < hdr.width()/2 ? 0.01f : 10.0f) * (1.0f + 0.1f*z + 0.01f*y);
+    }
+    hdr(3,4,0) = hdr(3,4,1) = hdr(3,4,2) = 0.0f;
+
+    Image ref  = toneMap(hdr, 100, 1, TONEMAP_BILATERAL);
+    Image fast = toneMap(hdr, 100, 1, TONEMAP_BILATERAL_GRID);
+    // the black pixel has no chrominance (0/0) on both paths, so only compare
+    // where the exact result is finite
+    int nonFinite = 0, n = 0;
+    double sum = 0.0;
+    for (int i = 0; i < fast.number_of_elements(); i++) {
+        if (isfinite(ref(i)) != isfinite(fast(i))) nonFinite++;
+        if (isfinite(ref(i))) {
+            sum += (ref(i) - fast(i))*(ref(i) - fast(i));
+            n++;
+        }
+    }
+    cout << "toneMap grid outputs non-finite unlike exact: " << nonFinite << endl;
+    cout << "toneMap grid rms error: " << sqrt(sum / n) << endl;
+
+    Image gray = noisyStepImage(32, 32, 1);
+    Image guide = gray;
+    guide(5,5,0) = -INFINITY;
+    guide(6,5,0) = NAN;
+    Image out = bilateralGrid(gray, guide, 0.1, 2.0);
+    nonFinite = 0;
+    for (int i = 0; i < out.number_of_elements(); i++) {
+        if (!isfinite(out(i))) nonFinite++;
+    }
+    cout << "bilateral grid non-finite outputs (bad guide): " << nonFinite << endl;
+}
+
+// The table-driven bilateral should match the per-tap reference
+void testBilateralExact() {
+    Image color = noisyStepImage(128, 128, 3);
+
+    auto t0 = chrono::steady_clock::now();
+    Image ref = bilateral_reference(color, 0.1, 2.0);
+    auto t1 = chrono::steady_clock::now();
+    Image out = bilateral(color, 0.1, 2.0);
+    auto t2 = chrono::steady_clock::now();
+
+    float maxErr = 0.0f;
+    for (int i = 0; i < ref.number_of_elements(); i++) {
+        maxErr = max(maxErr, fabs(ref(i) - out(i)));
+    }
+    cout << "bilateral max error vs reference: " << maxErr << endl;
+    cout << "reference: " << chrono::duration<double>(t1-t0).count() << "s, "
+         << "bilateral: " << chrono::duration<double>(t2-t1).count() << "s" << endl;
+}
+
+// The single pass bilaYUV should match two full bilateral passes
+void testBilaYUVJoint() {
+    Image color = noisyStepImage(128, 128, 3);
+
+    Image imYUV = rgb2yuv(color);
+    Image bilY  = bilateral(imYUV, 0.1, 1.0);
+    Image bilUV = bilateral(imYUV, 0.1, 3.0);
+    for (int y = 0; y < imYUV.height(); y++)
+    for (int x = 0; x < imYUV.width(); x++)
+    {
+        imYUV(x,y,0) = bilY(x,y,0);
+        imYUV(x,y,1) = bilUV(x,y,1);
+        imYUV(x,y,2) = bilUV(x,y,2);
+    }
+    Image twoPass = yuv2rgb(imYUV);
+
+    Image joint = bilaYUV(color, 0.1, 1.0, 3.0);
+    cout << "bilaYUV joint rms error vs two passes: " << rmsError(twoPass, joint) << endl;
+}
+
+// Guided filter: box means against the direct box blur, edge preservation
+// on a step, and tone mapping a synthetic hdr ramp with it
+void testGuidedFilter() {
+    Image color = noisyStepImage(96, 96, 3);
+    Image box = boxMean(color, 3);
+    Image ref = boxBlur(color, 7);
+    float maxErr = 0.0f;
+    for (int y = 3; y < color.height()-3; y++)
+    for (int x = 3; x < color.width()-3; x++)
+    for (int z = 0; z < color.channels(); z++)
+        maxErr = max(maxErr, fabs(box(x,y,z) - ref(x,y,z)));
+    cout << "boxMean max error vs boxBlur (interior): " << maxErr << endl;
+
+    Image gray = noisyStepImage(96, 96, 1);
+    Image guided = guidedFilter(gray, 8, 0.01);
+    cout << "guided filter rms error vs bilateral: " << rmsError(guided, bilateral(gray, 0.1, 4.0)) << endl;
+    guided.write("./Output/guided-gray.png");
+
+    Image hdr(192, 128, 3);
+    for (int y = 0; y < hdr.height(); y++)
+    for (int x = 0; x < hdr.width(); x++)
+    for (int z = 0; z < hdr.channels(); z++)
+        hdr(x,y,z) = pow(10.0f, 4.0f*x/hdr.width()) * (y < hdr.height()/2 ? 1.0f : 0.01f) * (0.5f + 0.2f*z);
+    Image tm = toneMap(hdr, 100, 3, TONEMAP_GUIDED, 0.1);
+    changeGamma(tm, 1.0, 1.0/2.2).write("./Output/ramp-tonedHDR-guided.png");
+}
+
+
+void testDomainTransform() {
+    Image gray = noisyStepImage(256, 256, 1);
+    Image clean = noisyStepImage(256, 256, 1, 0.0f);
+
+    auto t0 = chrono::steady_clock::now();
+    Image dt = domainTransform(gray, 0.1, 4.0);
+    auto t1 = chrono::steady_clock::now();
+    Image bil = bilateral(gray, 0.1, 4.0);
+    auto t2 = chrono::steady_clock::now();
+
+    cout << "domain transform rms error vs clean step: " << rmsError(dt, clean)
+         << " (noisy input " << rmsError(gray, clean) << ", bilateral " << rmsError(bil, clean) << ")" << endl;
+    cout << "domain transform: " << chrono::duration<double>(t1-t0).count() << "s, "
+         << "exact bilateral: " << chrono::duration<double>(t2-t1).count() << "s" << endl;
+    dt.write("./Output/domainTransform-gray.png");
+
+    Image color = noisyStepImage(128, 128, 3);
+    cout << "domainTransformYUV rms error vs bilaYUV: "
+         << rmsError(domainTransformYUV(color, 0.1, 1.0, 4.0), bilaYUV(color, 0.1, 1.0, 4.0)) << endl;
+
+    Image hdr(192, 128, 3);
+    for (int y = 0; y < hdr.height(); y++)
+    for (int x = 0; x < hdr.width(); x++)
+    for (int z = 0; z < hdr.channels(); z++)
+        hdr(x,y,z) = pow(10.0f, 4.0f*x/hdr.width()) * (y < hdr.height()/2 ? 1.0f : 0.01f) * (0.5f + 0.2f*z);
+    Image tm = toneMap(hdr, 100, 3, TONEMAP_DOMAIN_TRANSFORM, 0.1);
+    changeGamma(tm, 1.0, 1.0/2.2).write("./Output/ramp-tonedHDR-domainTransform.png");
+}
+
+// The fused color transforms against the multi-pass formulas
+void testColorTransform() {
+    Image im = noisyStepImage(64, 48, 3, 0.1);
+
+    Image yuv = rgb2yuv(im);
+    for (int y = 0; y < im.height(); y++)
+    for (int x = 0; x < im.width(); x++)
+    {
+        yuv(x,y,1) *= 1.7f;
+        yuv(x,y,2) *= 1.7f;
+    }
+    ColorTransform sat = ColorTransform::rgb2yuv()
+        .then(ColorTransform::scale(1.0f, 1.7f, 1.7f))
+        .then(ColorTransform::yuv2rgb());
+    cout << "saturate stages: " << sat.stages()
+         << ", rms error: " << rmsError(saturate(im, 1.7f), yuv2rgb(yuv)) << endl;
+
+    vector<Image> lc = lumiChromi(im);
+    Image lumi = contrast(brightness(lc[0], 1.2f), 0.8f, 0.3f);
+    cout << "brightnessContrastLumi rms error: "
+         << rmsError(brightnessContrastLumi(im, 1.2f, 0.8f, 0.3f), lumiChromi2rgb(vector<Image>{lumi, lc[1]})) << endl;
+    cout << "lumiChromi round trip rms error: " << rmsError(lumiChromi2rgb(lc), im) << endl;
+
+    float mean[3] = {0, 0, 0};
+    for (int z = 0; z < 3; z++)
+    for (int y = 0; y < im.height(); y++)
+    for (int x = 0; x < im.width(); x++)
+        mean[z] += im(x,y,z) / (im.width()*im.height());
+    Image balanced = grayworld(im);
+    float maxErr = 0.0f;
+    for (int z = 0; z < 3; z++)
+    for (int y = 0; y < im.height(); y++)
+    for (int x = 0; x < im.width(); x++)
+        maxErr = max(maxErr, fabs(balanced(x,y,z) - im(x,y,z)/mean[z]*mean[1]));
+    cout << "grayworld max error: " << maxErr << endl;
+}
 
 // This is a way for you to test your functions. 
 // We will only grade the contents of demosaic.cpp and align.cpp
@@ -201,6 +415,13 @@ int main() {
     std::cout << "before tone boston" << std::endl;
     testToneMapping_boston();
     */
+    testBilateralGrid();
+    testToneMapGrid();
+    testBilateralExact();
+    testBilaYUVJoint();
+    testGuidedFilter();
+    testDomainTransform();
+    testColorTransform();
     testToneMapping_design();
     
     return 0;
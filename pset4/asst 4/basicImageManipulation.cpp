@@ -9,6 +9,7 @@
 
 
 #include "basicImageManipulation.h"
+#include "colorTransform.h"
 using namespace std;
 
 // --------- HANDOUT PS01 ------------------------------
@@ -91,8 +92,11 @@ Image lumiChromi2rgb(const vector<Image> & lc) {
     // luminance is lc[0]
     // chrominance is lc[1]
 
-    // Create chrominance images
-    // We copy the input as starting point for the chrominance
+    // the luminance is a per-pixel gain on the chrominance
+    if (lc[1].channels() == 3) {
+        return ColorTransform().apply(lc[1], lc[0]);
+    }
+
     Image im = Image(lc[1].width(), lc[1].height(), lc[1].channels()); 
     for (int c = 0 ; c < im.channels(); c++ )
     for (int y = 0 ; y < im.height(); y++) 
@@ -112,25 +116,11 @@ Image brightnessContrastLumi(const Image &im, float brightF, float contrastF, fl
     // return Image(1,1,1); // Change this
     
     // --------- SOLUTION PS01 ------------------------------
-    // Separate luminance and chrominance
-    std::vector<Image> lumi_chromi = lumiChromi(im);
-    Image im_luminance             = lumi_chromi[0];
-    Image im_chrominance           = lumi_chromi[1];
-
-    // Process the luminance channel
-    im_luminance = brightness(im_luminance, brightF);
-    im_luminance = contrast(im_luminance, contrastF, midpoint);
-
-    // Multiply the chrominance with the new luminance to get the final image
-    for (int i = 0 ; i < im.width(); i++ ){
-        for (int j = 0 ; j < im.height(); j++) {
-            for (int c = 0; c < im.channels(); c++) {
-                im_chrominance(i,j,c) = im_chrominance(i,j,c) * im_luminance(i,j);
-            }
-        }
-    }
-    // At this point, im_chrominance olds the complete processed image
-    return im_chrominance;
+    // Rescaling the chrominance by the new luminance amounts to scaling
+    // every pixel by newL/L, done in one pass without the intermediate
+    // luminance and chrominance images
+    ColorCurve lumiCurve = [=](float L) { return (L*brightF - midpoint)*contrastF + midpoint; };
+    return ColorTransform::luminance(lumiCurve).apply(im);
 }
 
 
@@ -180,15 +170,11 @@ Image saturate(const Image &im, float factor) {
     // return Image(1,1,1); // Change this
     
     // --------- SOLUTION PS01 ------------------------------
-    Image output = rgb2yuv(im); // Change colorspace
-    for (int i = 0 ; i < im.width(); i++) {
-        for (int j = 0 ; j < im.height(); j++) {
-            output(i,j,1) = output(i,j,1) * factor;
-            output(i,j,2) = output(i,j,2) * factor;
-        }
-    }
-    output = yuv2rgb(output); // Back to RGB
-    return output;  
+    // rgb2yuv, chroma scaling and yuv2rgb compose into a single 3x3 matrix
+    ColorTransform sat = ColorTransform::rgb2yuv()
+        .then(ColorTransform::scale(1.0f, factor, factor))
+        .then(ColorTransform::yuv2rgb());
+    return sat.apply(im);
 }
 
 
@@ -260,16 +246,8 @@ Image grayworld(const Image & im) {
     mean_g /= N;
     mean_b /= N;
 
-    Image output = im;
-    for (int j = 0 ; j < im.height();j ++)
-    for (int i = 0 ; i < im.width(); i++)
-    {
-        output(i,j,0) = output(i,j,0)/mean_r*mean_g;
-        // dont process output(i,j,1), since the mean of
-        // the green channel is already at the right value
-        output(i,j,2) = output(i,j,2)/mean_b*mean_g;
-    }
-    return output;
+    // the green channel is already at the right value
+    return ColorTransform::scale(mean_g/mean_r, 1.0f, mean_g/mean_b).apply(im);
 }
 
 // -----------------------------------------------------
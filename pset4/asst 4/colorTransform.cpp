@@ -0,0 +1,162 @@
+/* --------------------------------------------------------------------------
+ * File:    colorTransform.cpp
+ * Created: 2026-10-18
+ * --------------------------------------------------------------------------
+ *
+ * Per-pixel color transforms composed symbolically and applied in one pass
+ *
+ * ------------------------------------------------------------------------*/
+
+
+#include "colorTransform.h"
+
+using namespace std;
+
+static const float lumiWeights[3] = {0.299f, 0.587f, 0.114f};
+
+ColorTransform::ColorTransform() {}
+
+ColorTransform::Stage ColorTransform::affineStage() {
+    Stage s;
+    s.isLuminance = false;
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) s.m[i][j] = (i == j) ? 1.0f : 0.0f;
+        s.offset[i] = 0.0f;
+    }
+    return s;
+}
+
+ColorTransform ColorTransform::matrix(const float m[3][3], const float offset[3]) {
+    ColorTransform t;
+    Stage s = affineStage();
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) s.m[i][j] = m[i][j];
+        s.offset[i] = offset ? offset[i] : 0.0f;
+    }
+    t.chain.push_back(s);
+    return t;
+}
+
+ColorTransform ColorTransform::scale(float r, float g, float b) {
+    const float m[3][3] = {{r, 0, 0}, {0, g, 0}, {0, 0, b}};
+    return matrix(m);
+}
+
+ColorTransform ColorTransform::curves(const ColorCurve &r, const ColorCurve &g, const ColorCurve &b) {
+    ColorTransform t;
+    Stage s = affineStage();
+    s.curves.push_back(r);
+    s.curves.push_back(g);
+    s.curves.push_back(b);
+    t.chain.push_back(s);
+    return t;
+}
+
+ColorTransform ColorTransform::luminance(const ColorCurve &curve, const float weights[3]) {
+    ColorTransform t;
+    Stage s = affineStage();
+    s.isLuminance = true;
+    for (int j = 0; j < 3; j++) s.m[0][j] = weights ? weights[j] : lumiWeights[j];
+    s.curves.push_back(curve);
+    t.chain.push_back(s);
+    return t;
+}
+
+ColorTransform ColorTransform::rgb2yuv() {
+    // same coefficients as rgb2yuv in basicImageManipulation
+    const float m[3][3] = {
+        { 0.299f,  0.587f,  0.114f},
+        {-0.147f, -0.289f,  0.436f},
+        { 0.615f, -0.515f, -0.100f}};
+    return matrix(m);
+}
+
+ColorTransform ColorTransform::yuv2rgb() {
+    const float m[3][3] = {
+        {1.0f,  0.0f,    1.14f},
+        {1.0f, -0.395f, -0.581f},
+        {1.0f,  2.032f,  0.0f}};
+    return matrix(m);
+}
+
+
+ColorTransform ColorTransform::then(const ColorTransform &next) const {
+    ColorTransform t = *this;
+    for (const Stage &s : next.chain) {
+        if (!s.isLuminance && !t.chain.empty()
+                && !t.chain.back().isLuminance && t.chain.back().curves.empty()) {
+            // fold the previous affine stage into this one
+            const Stage &prev = t.chain.back();
+            Stage merged = s;
+            for (int i = 0; i < 3; i++) {
+                merged.offset[i] = s.offset[i];
+                for (int j = 0; j < 3; j++) {
+                    merged.m[i][j] = 0.0f;
+                    for (int k = 0; k < 3; k++) merged.m[i][j] += s.m[i][k] * prev.m[k][j];
+                    merged.offset[i] += s.m[i][j] * prev.offset[j];
+                }
+            }
+            t.chain.back() = merged;
+        } else {
+            t.chain.push_back(s);
+        }
+    }
+    return t;
+}
+
+
+void ColorTransform::run(float rgb[3]) const {
+    for (const Stage &s : chain) {
+        if (s.isLuminance) {
+            float L = s.m[0][0]*rgb[0] + s.m[0][1]*rgb[1] + s.m[0][2]*rgb[2];
+            float newL = s.curves[0](L);
+            for (int c = 0; c < 3; c++) rgb[c] = rgb[c] / L * newL;
+            continue;
+        }
+        float out[3];
+        for (int i = 0; i < 3; i++) {
+            out[i] = s.m[i][0]*rgb[0] + s.m[i][1]*rgb[1] + s.m[i][2]*rgb[2] + s.offset[i];
+        }
+        for (int i = 0; i < 3; i++) {
+            rgb[i] = s.curves.empty() ? out[i] : s.curves[i](out[i]);
+        }
+    }
+}
+
+Image ColorTransform::apply(const Image &im) const {
+    if (im.channels() != 3)
+        throw ChannelException();
+    int n = im.width()*im.height();
+    Image output(im.width(), im.height(), 3);
+
+    // every pixel goes through the whole chain while it is in registers
+    #pragma omp parallel for
+    for (int i = 0; i < n; i++) {
+        float rgb[3] = {im(i), im(i + n), im(i + 2*n)};
+        run(rgb);
+        output(i) = rgb[0];
+        output(i + n) = rgb[1];
+        output(i + 2*n) = rgb[2];
+    }
+    return output;
+}
+
+Image ColorTransform::apply(const Image &im, const Image &gain) const {
+    if (im.channels() != 3)
+        throw ChannelException();
+    if (gain.width() != im.width() || gain.height() != im.height())
+        throw MismatchedDimensionsException();
+    int n = im.width()*im.height();
+    Image output(im.width(), im.height(), 3);
+
+    #pragma omp parallel for
+    for (int i = 0; i < n; i++) {
+        float g = gain(i);
+        float rgb[3] = {im(i)*g, im(i + n)*g, im(i + 2*n)*g};
+        run(rgb);
+        output(i) = rgb[0];
+        output(i + n) = rgb[1];
+        output(i + 2*n) = rgb[2];
+    }
+    return output;
+}
@@ -0,0 +1,66 @@
+/* --------------------------------------------------------------------------
+ * File:    colorTransform.h
+ * Created: 2026-10-18
+ * --------------------------------------------------------------------------
+ *
+ * Per-pixel color transforms composed symbolically and applied in one pass
+ *
+ * ------------------------------------------------------------------------*/
+
+
+#ifndef __colorTransform__h
+#define __colorTransform__h
+
+#include "Image.h"
+#include <functional>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+typedef std::function<float(float)> ColorCurve;
+
+// A chain of stages applied to every RGB pixel. A stage is either
+//  - affine: out = curve_c(M*in + offset), the curves being optional, or
+//  - luminance: the pixel is scaled so that its luminance L = w.in becomes
+//    curve(L), i.e. out = in / L * curve(L).
+// Chaining affine stages multiplies their matrices, so a chain of
+// conversions costs a single 3x3 product per pixel.
+class ColorTransform {
+public:
+    // Identity
+    ColorTransform();
+
+    static ColorTransform matrix(const float m[3][3], const float offset[3]=NULL);
+    static ColorTransform scale(float r, float g, float b);
+    static ColorTransform curves(const ColorCurve &r, const ColorCurve &g, const ColorCurve &b);
+    static ColorTransform luminance(const ColorCurve &curve, const float weights[3]=NULL);
+    static ColorTransform rgb2yuv();
+    static ColorTransform yuv2rgb();
+
+    // This transform followed by next
+    ColorTransform then(const ColorTransform &next) const;
+
+    // Number of stages left after composition
+    int stages() const { return int(chain.size()); }
+
+    // Transform every pixel of a 3-channel image in a single pass. With a
+    // gain image, each pixel is first multiplied by the gain at that pixel
+    // (channel 0).
+    Image apply(const Image &im) const;
+    Image apply(const Image &im, const Image &gain) const;
+
+private:
+    struct Stage {
+        bool isLuminance;
+        float m[3][3];
+        float offset[3];
+        vector<ColorCurve> curves; // empty, or one per channel
+    };
+    vector<Stage> chain;
+
+    static Stage affineStage();
+    void run(float rgb[3]) const;
+};
+
+#endif
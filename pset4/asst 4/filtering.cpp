@@ -11,6 +11,7 @@
 #include "filtering.h"
 #include <cmath>
 #include <cassert>
+#include <algorithm>
 
 using namespace std;
 
@@ -253,11 +254,109 @@ Image unsharpMask(const Image &im, float sigma, float truncate, float strength,
 }
 
 
-Image bilateral(const Image &im, float sigmaRange, float sigmaDomain, float truncateDomain, bool clamp){
+// Padded, pixel-interleaved copy of an image: the channels of a pixel are
+// contiguous and the border is filled like smartAccessor would (clamped or
+// black), so the filter loops need no bounds checks.
+static vector<float> paddedInterleaved(const Image &im, int pad, bool clamp){
+    int pw = im.width() + 2*pad;
+    int ph = im.height() + 2*pad;
+    int nc = im.channels();
+    vector<float> buffer(pw*ph*nc);
+    for (int y=0; y<ph; y++)
+    for (int x=0; x<pw; x++)
+    for (int z=0; z<nc; z++)
+        buffer[(y*pw + x)*nc + z] = im.smartAccessor(x-pad, y-pad, z, clamp);
+    return buffer;
+}
+
+// exp(-t) tabulated on [0, RANGE_LUT_MAX] and linearly interpolated. The
+// relative error is below 1e-5, and weights past the end are below 4e-11.
+static const int   RANGE_LUT_SIZE = 4096;
+static const float RANGE_LUT_MAX  = 24.0f;
+
+static vector<float> rangeLUT(){
+    vector<float> lut(RANGE_LUT_SIZE + 2);
+    for (int i=0; i<(int)lut.size(); i++) {
+        lut[i] = exp(-i * RANGE_LUT_MAX / RANGE_LUT_SIZE);
+    }
+    return lut;
+}
+
+static inline float rangeWeight(const vector<float> &lut, float t){
+    if (t >= RANGE_LUT_MAX) return 0.0f;
+    float f = t * (RANGE_LUT_SIZE / RANGE_LUT_MAX);
+    int i = int(f);
+    return lut[i] + (f - i) * (lut[i+1] - lut[i]);
+}
+
+Image bilateral(const Image &im, float sigmaRange, float sigmaDomain, float truncateDomain, bool clamp, bool fast){
     // // --------- HANDOUT  PS02 ------------------------------
     // // Denoise an image using the bilateral filter
     // return im;
     
+    // approximate the filter on a bilateral grid if requested
+    if (fast) {
+        return bilateralGrid(im, sigmaRange, sigmaDomain);
+    }
+
+    Image imFilter(im.width(), im.height(), im.channels());
+    
+    // calculate the filter size
+    int offset   = int(ceil(truncateDomain * sigmaDomain));
+    int sizeFilt = 2*offset + 1;
+    int nc = im.channels();
+    int pw = im.width() + 2*offset;
+    vector<float> padded = paddedInterleaved(im, offset, clamp);
+
+    // the domain weights and neighbor offsets only depend on the tap
+    vector<float> domain(sizeFilt*sizeFilt);
+    vector<int> neighbor(sizeFilt*sizeFilt);
+    for (int yFilter=0; yFilter<sizeFilt; yFilter++)
+    for (int xFilter=0; xFilter<sizeFilt; xFilter++)
+    {
+        int dx = xFilter-offset, dy = yFilter-offset;
+        domain[yFilter*sizeFilt + xFilter]   = exp( -(dx*dx + dy*dy) / (2.0 * sigmaDomain*sigmaDomain) );
+        neighbor[yFilter*sizeFilt + xFilter] = (dy*pw + dx)*nc;
+    }
+
+    vector<float> lut = rangeLUT();
+    float rangeScale = 1.0f / (2.0f * sigmaRange*sigmaRange);
+
+    // rows are independent
+    #pragma omp parallel for schedule(dynamic, 4)
+    for (int y=0; y<im.height(); y++) {
+        vector<float> accum(nc);
+        for (int x=0; x<im.width(); x++) {
+            const float *center = &padded[((y+offset)*pw + x+offset)*nc];
+            float normalizer = 0.0f;
+            fill(accum.begin(), accum.end(), 0.0f);
+
+            // one weight per tap, shared by all the output channels
+            for (int k=0; k<(int)domain.size(); k++) {
+                const float *nb = center + neighbor[k];
+                float range_dist = 0.0f; // |R-R1|^2 + |G-G1|^2 + |B-B1|^2
+                for (int z=0; z<nc; z++) {
+                    float tmp = center[z] - nb[z];
+                    range_dist += tmp*tmp;
+                }
+                float w = domain[k] * rangeWeight(lut, range_dist * rangeScale);
+                normalizer += w;
+                for (int z=0; z<nc; z++) {
+                    accum[z] += w * nb[z];
+                }
+            }
+
+            for (int z=0; z<nc; z++) {
+                imFilter(x,y,z) = accum[z]/normalizer;
+            }
+        }
+    }
+
+    return imFilter;
+}
+
+
+Image bilateral_reference(const Image &im, float sigmaRange, float sigmaDomain, float truncateDomain, bool clamp){
     // --------- SOLUTION PS02 ------------------------------
     Image imFilter(im.width(), im.height(), im.channels());
     
@@ -309,7 +408,71 @@ Image bilateral(const Image &im, float sigmaRange, float sigmaDomain, float trun
 }
 
 
-Image bilaYUV(const Image &im, float sigmaRange, float sigmaY, float sigmaUV, float truncateDomain, bool clamp){
+// Joint Y/UV bilateral in a single traversal of the larger window. The
+// range weight on the full YUV distance is computed once per neighbor and
+// shared by the Y output (small domain) and the UV outputs (large domain).
+static Image bilateralYUVJoint(const Image &imYUV, float sigmaRange, float sigmaY, float sigmaUV, float truncateDomain, bool clamp){
+    Image out(imYUV.width(), imYUV.height(), 3);
+
+    int offsetY  = int(ceil(truncateDomain * sigmaY));
+    int offsetUV = int(ceil(truncateDomain * sigmaUV));
+    int offset   = max(offsetY, offsetUV);
+    int sizeFilt = 2*offset + 1;
+    int pw = imYUV.width() + 2*offset;
+    vector<float> padded = paddedInterleaved(imYUV, offset, clamp);
+
+    // domain weights of both windows on the common support, 0 outside each
+    vector<float> domainY(sizeFilt*sizeFilt), domainUV(sizeFilt*sizeFilt);
+    vector<int> neighbor(sizeFilt*sizeFilt);
+    for (int yFilter=0; yFilter<sizeFilt; yFilter++)
+    for (int xFilter=0; xFilter<sizeFilt; xFilter++)
+    {
+        int dx = xFilter-offset, dy = yFilter-offset;
+        int k = yFilter*sizeFilt + xFilter;
+        bool inY  = abs(dx) <= offsetY  && abs(dy) <= offsetY;
+        bool inUV = abs(dx) <= offsetUV && abs(dy) <= offsetUV;
+        domainY[k]  = inY  ? exp( -(dx*dx + dy*dy) / (2.0 * sigmaY*sigmaY) ) : 0.0f;
+        domainUV[k] = inUV ? exp( -(dx*dx + dy*dy) / (2.0 * sigmaUV*sigmaUV) ) : 0.0f;
+        neighbor[k] = (dy*pw + dx)*3;
+    }
+
+    vector<float> lut = rangeLUT();
+    float rangeScale = 1.0f / (2.0f * sigmaRange*sigmaRange);
+
+    #pragma omp parallel for schedule(dynamic, 4)
+    for (int y=0; y<imYUV.height(); y++)
+    for (int x=0; x<imYUV.width(); x++)
+    {
+        const float *center = &padded[((y+offset)*pw + x+offset)*3];
+        float normY = 0.0f, accumY = 0.0f;
+        float normUV = 0.0f, accumU = 0.0f, accumV = 0.0f;
+
+        for (int k=0; k<(int)neighbor.size(); k++) {
+            const float *nb = center + neighbor[k];
+            float d0 = center[0] - nb[0];
+            float d1 = center[1] - nb[1];
+            float d2 = center[2] - nb[2];
+            float r = rangeWeight(lut, (d0*d0 + d1*d1 + d2*d2) * rangeScale);
+
+            float wY  = domainY[k] * r;
+            float wUV = domainUV[k] * r;
+            normY  += wY;
+            accumY += wY * nb[0];
+            normUV += wUV;
+            accumU += wUV * nb[1];
+            accumV += wUV * nb[2];
+        }
+
+        out(x,y,0) = accumY / normY;
+        out(x,y,1) = accumU / normUV;
+        out(x,y,2) = accumV / normUV;
+    }
+
+    return out;
+}
+
+
+Image bilaYUV(const Image &im, float sigmaRange, float sigmaY, float sigmaUV, float truncateDomain, bool clamp, bool fast){
     // // --------- HANDOUT  PS02 ------------------------------
     // // 6.865 only
     // // Bilaterial Filter an image seperatly for
@@ -319,10 +482,19 @@ Image bilaYUV(const Image &im, float sigmaRange, float sigmaY, float sigmaUV, fl
     //convert from RGB to YUV
     Image imYUV = rgb2yuv(im);
 
-    // We pass the whole imYUV to bilateral, since we want to compute the
-    // weight on the full YUV range
-    Image bilY  = bilateral(imYUV, sigmaRange, sigmaY, truncateDomain, clamp);
-    Image bilUV = bilateral(imYUV, sigmaRange, sigmaUV, truncateDomain, clamp);
+    if (!fast) {
+        // We use the whole imYUV for the weights, since we want to compute
+        // them on the full YUV range
+        return yuv2rgb(bilateralYUVJoint(imYUV, sigmaRange, sigmaY, sigmaUV, truncateDomain, clamp));
+    }
+
+    // the grid only supports a 1D range, so both passes are guided by Y
+    Image lumi(im.width(), im.height(), 1);
+    for (int y=0; y<im.height(); y++)
+    for (int x=0; x<im.width(); x++)
+        lumi(x,y,0) = imYUV(x,y,0);
+    Image bilY  = bilateralGrid(imYUV, lumi, sigmaRange, sigmaY);
+    Image bilUV = bilateralGrid(imYUV, lumi, sigmaRange, sigmaUV);
     
     // put the Y and UV parts of the image back into one image
     for(int i=0; i<im.width(); i++)
@@ -339,6 +511,336 @@ Image bilaYUV(const Image &im, float sigmaRange, float sigmaY, float sigmaUV, fl
     return bilRGB;
 }
 
+Image bilateralGrid(const Image &im, float sigmaRange, float sigmaDomain){
+    // use the image itself as the range guide when it is grayscale, and its
+    // luminance otherwise
+    if (im.channels() == 1) {
+        return bilateralGrid(im, im, sigmaRange, sigmaDomain);
+    }
+    if (im.channels() == 3) {
+        return bilateralGrid(im, color2gray(im), sigmaRange, sigmaDomain);
+    }
+    Image guide(im.width(), im.height(), 1);
+    for (int z=0; z<im.channels(); z++)
+    for (int y=0; y<im.height(); y++)
+    for (int x=0; x<im.width(); x++)
+        guide(x,y,0) += im(x,y,z) / im.channels();
+    return bilateralGrid(im, guide, sigmaRange, sigmaDomain);
+}
+
+
+Image bilateralGrid(const Image &im, const Image &guide, float sigmaRange, float sigmaDomain){
+    // Bilateral grid (Chen, Paris & Durand 2007). The grid is sampled at
+    // sigmaDomain in x,y and sigmaRange in the guide's range, so a gaussian
+    // of std 1 cell on the grid corresponds to the bilateral kernel.
+    assert(guide.width() == im.width() && guide.height() == im.height());
+
+    const int pad = 2; // support of the [1 4 6 4 1] blur
+    // range of the finite guide values; without one (or if it overflows)
+    // the grid has a single bin in range
+    float gMin = FLT_MAX, gMax = -FLT_MAX;
+    for (int y=0; y<guide.height(); y++)
+    for (int x=0; x<guide.width(); x++)
+    {
+        float g = guide(x,y,0);
+        if (isfinite(g)) {
+            gMin = min(gMin, g);
+            gMax = max(gMax, g);
+        }
+    }
+    float rangeBins = (gMax - gMin) / sigmaRange;
+    if (!(gMin <= gMax) || !isfinite(rangeBins)) {
+        gMin = gMax = 0.0f;
+        rangeBins = 0.0f;
+    }
+
+    int gw = int((im.width()-1) / sigmaDomain) + 1 + 2*pad;
+    int gh = int((im.height()-1) / sigmaDomain) + 1 + 2*pad;
+    int gd = int(rangeBins) + 1 + 2*pad;
+    // range coordinate of a guide value, clamped in float before any int
+    // conversion so that infinite or NaN guides land on the end bins. Finite
+    // values stay below gd-pad, and the slice reads up to one cell above.
+    auto rangeCoord = [&](float g) {
+        float f = (g - gMin) / sigmaRange + pad;
+        if (!(f >= pad)) return float(pad);
+        return min(f, float(gd - pad));
+    };
+    int nc = im.channels() + 1; // last channel holds the homogeneous weight
+
+    // grid cells are stored as ((k*gh + j)*gw + i)*nc + c
+    vector<float> grid(gw*gh*gd*nc, 0.0f);
+
+    // splat: accumulate every pixel in its nearest grid cell
+    for (int y=0; y<im.height(); y++)
+    for (int x=0; x<im.width(); x++)
+    {
+        int i = int(x / sigmaDomain + 0.5f) + pad;
+        int j = int(y / sigmaDomain + 0.5f) + pad;
+        int k = int(rangeCoord(guide(x,y,0)) + 0.5f);
+        float *cell = &grid[((k*gh + j)*gw + i)*nc];
+        for (int z=0; z<im.channels(); z++) {
+            cell[z] += im(x,y,z);
+        }
+        cell[nc-1] += 1.0f;
+    }
+
+    // blur: separable [1 4 6 4 1]/16 (variance 1 cell) along x, y and range.
+    // The padding keeps the blurred content away from the grid's border.
+    const float taps[5] = {1.0f/16, 4.0f/16, 6.0f/16, 4.0f/16, 1.0f/16};
+    int strides[3] = {nc, gw*nc, gw*gh*nc};
+    int extents[3] = {gw, gh, gd};
+    vector<float> tmp(grid.size());
+    for (int axis=0; axis<3; axis++) {
+        int stride = strides[axis];
+        for (int k=0; k<gd; k++)
+        for (int j=0; j<gh; j++)
+        for (int i=0; i<gw; i++)
+        {
+            int pos[3] = {i, j, k};
+            int base = ((k*gh + j)*gw + i)*nc;
+            for (int c=0; c<nc; c++) {
+                float accum = 0.0f;
+                for (int t=-2; t<=2; t++) {
+                    int n = pos[axis] + t;
+                    if (n < 0 || n >= extents[axis]) continue;
+                    accum += taps[t+2] * grid[base + t*stride + c];
+                }
+                tmp[base + c] = accum;
+            }
+        }
+        grid.swap(tmp);
+    }
+
+    // slice: trilinear interpolation of the grid at each pixel's position
+    Image imFilter(im.width(), im.height(), im.channels());
+    vector<float> value(nc);
+    for (int y=0; y<im.height(); y++)
+    for (int x=0; x<im.width(); x++)
+    {
+        float fx = x / sigmaDomain + pad;
+        float fy = y / sigmaDomain + pad;
+        float fz = rangeCoord(guide(x,y,0));
+        int i = int(fx), j = int(fy), k = int(fz);
+        float ax = fx - i, ay = fy - j, az = fz - k;
+
+        fill(value.begin(), value.end(), 0.0f);
+        for (int dk=0; dk<2; dk++)
+        for (int dj=0; dj<2; dj++)
+        for (int di=0; di<2; di++)
+        {
+            float w = (di ? ax : 1.0f-ax) * (dj ? ay : 1.0f-ay) * (dk ? az : 1.0f-az);
+            const float *cell = &grid[(((k+dk)*gh + j+dj)*gw + i+di)*nc];
+            for (int c=0; c<nc; c++) {
+                value[c] += w * cell[c];
+            }
+        }
+
+        // normalize by the homogeneous weight
+        for (int z=0; z<im.channels(); z++) {
+            imFilter(x,y,z) = value[nc-1] > 0.0f ? value[z] / value[nc-1] : im(x,y,z);
+        }
+    }
+
+    return imFilter;
+}
+
+Image boxMean(const Image &im, int radius){
+    // Running sums along x then y: each output costs one add and one
+    // subtract whatever the radius. Windows are truncated at the border and
+    // normalized by the number of pixels they actually cover.
+    int w = im.width(), h = im.height();
+    Image tmp(w, h, im.channels());
+    Image out(w, h, im.channels());
+
+    #pragma omp parallel for
+    for (int y=0; y<h; y++)
+    for (int z=0; z<im.channels(); z++)
+    {
+        double sum = 0.0;
+        for (int x=0; x<min(radius, w); x++) sum += im(x,y,z);
+        for (int x=0; x<w; x++) {
+            if (x+radius < w)    sum += im(x+radius,y,z);
+            if (x-radius-1 >= 0) sum -= im(x-radius-1,y,z);
+            int count = min(x+radius, w-1) - max(x-radius, 0) + 1;
+            tmp(x,y,z) = sum / count;
+        }
+    }
+
+    #pragma omp parallel for
+    for (int x=0; x<w; x++)
+    for (int z=0; z<im.channels(); z++)
+    {
+        double sum = 0.0;
+        for (int y=0; y<min(radius, h); y++) sum += tmp(x,y,z);
+        for (int y=0; y<h; y++) {
+            if (y+radius < h)    sum += tmp(x,y+radius,z);
+            if (y-radius-1 >= 0) sum -= tmp(x,y-radius-1,z);
+            int count = min(y+radius, h-1) - max(y-radius, 0) + 1;
+            out(x,y,z) = sum / count;
+        }
+    }
+    return out;
+}
+
+
+Image guidedFilter(const Image &im, int radius, float eps){
+    return guidedFilter(im, im, radius, eps);
+}
+
+
+Image guidedFilter(const Image &im, const Image &guide, int radius, float eps){
+    // Guided filter (He, Sun & Tang 2010): in every window the output is a
+    // linear function a*I+b of the guide I, fit by least squares to the
+    // input. Everything reduces to box means, so the cost does not depend
+    // on the radius.
+    assert(guide.width() == im.width() && guide.height() == im.height());
+    assert(guide.channels() == 1 || guide.channels() == im.channels());
+
+    // a single channel guide is shared by all the channels of the input
+    Image I(im.width(), im.height(), im.channels());
+    for (int z=0; z<im.channels(); z++)
+    for (int y=0; y<im.height(); y++)
+    for (int x=0; x<im.width(); x++)
+        I(x,y,z) = guide(x,y, guide.channels() == 1 ? 0 : z);
+
+    Image meanI  = boxMean(I, radius);
+    Image meanP  = boxMean(im, radius);
+    Image corrII = boxMean(I*I, radius);
+    Image corrIP = boxMean(I*im, radius);
+
+    Image a(im.width(), im.height(), im.channels());
+    Image b(im.width(), im.height(), im.channels());
+    for (int i=0; i<a.number_of_elements(); i++) {
+        float varI  = corrII(i) - meanI(i)*meanI(i);
+        float covIP = corrIP(i) - meanI(i)*meanP(i);
+        a(i) = covIP / (varI + eps);
+        b(i) = meanP(i) - a(i)*meanI(i);
+    }
+
+    // average the coefficients of all the windows covering each pixel
+    return boxMean(a, radius)*I + boxMean(b, radius);
+}
+
+
+// Columns per parallel task of the vertical domain transform pass
+static const int DT_COLUMN_STRIP = 64;
+
+// One recursive pass of the domain transform filter along the rows (alongX)
+// or the columns of a planar w x h x c buffer. dt holds a^d for every pixel,
+// the feedback coefficient between a sample and the previous one.
+static void domainTransformPass(vector<float> &buf, const vector<float> &dt, int w, int h, int c, bool alongX){
+    if (alongX) {
+        #pragma omp parallel for
+        for (int y=0; y<h; y++)
+        for (int z=0; z<c; z++)
+        {
+            float *row = &buf[(z*h + y)*w];
+            const float *d = &dt[y*w];
+            for (int x=1; x<w; x++)
+                row[x] += d[x] * (row[x-1] - row[x]);
+            for (int x=w-2; x>=0; x--)
+                row[x] += d[x+1] * (row[x+1] - row[x]);
+        }
+    } else {
+        // strips of columns run in parallel; within a strip, whole strip
+        // rows are swept at a time so the inner loop stays contiguous
+        int nStrips = (w + DT_COLUMN_STRIP - 1) / DT_COLUMN_STRIP;
+        #pragma omp parallel for
+        for (int t=0; t<c*nStrips; t++)
+        {
+            int z = t / nStrips;
+            int x0 = (t % nStrips) * DT_COLUMN_STRIP, x1 = min(x0 + DT_COLUMN_STRIP, w);
+            float *plane = &buf[z*h*w];
+            for (int y=1; y<h; y++)
+            for (int x=x0; x<x1; x++)
+                plane[y*w+x] += dt[y*w+x] * (plane[(y-1)*w+x] - plane[y*w+x]);
+            for (int y=h-2; y>=0; y--)
+            for (int x=x0; x<x1; x++)
+                plane[y*w+x] += dt[(y+1)*w+x] * (plane[(y+1)*w+x] - plane[y*w+x]);
+        }
+    }
+}
+
+Image domainTransform(const Image &im, float sigmaRange, float sigmaDomain, int iterations){
+    return domainTransform(im, im, sigmaRange, sigmaDomain, iterations);
+}
+
+Image domainTransform(const Image &im, const Image &guide, float sigmaRange, float sigmaDomain, int iterations){
+    // Domain transform recursive filter (Gastal & Oliveira 2011). The guide
+    // defines a 1D distance between neighbors, 1 + sigmaDomain/sigmaRange
+    // times the L1 difference of the guide, and a recursive exponential
+    // filter is run along that distance, alternating rows and columns.
+    assert(guide.width() == im.width() && guide.height() == im.height());
+    int w = im.width(), h = im.height(), c = im.channels();
+    float ratio = sigmaDomain / sigmaRange;
+
+    // distance to the previous neighbor along x and y
+    vector<float> dx(w*h), dy(w*h);
+    for (int y=0; y<h; y++)
+    for (int x=0; x<w; x++)
+    {
+        float sumX = 0.0f, sumY = 0.0f;
+        for (int z=0; z<guide.channels(); z++) {
+            if (x > 0) sumX += fabs(guide(x,y,z) - guide(x-1,y,z));
+            if (y > 0) sumY += fabs(guide(x,y,z) - guide(x,y-1,z));
+        }
+        dx[y*w+x] = 1.0f + ratio*sumX;
+        dy[y*w+x] = 1.0f + ratio*sumY;
+    }
+
+    vector<float> buf(w*h*c);
+    for (int z=0; z<c; z++)
+    for (int y=0; y<h; y++)
+    for (int x=0; x<w; x++)
+        buf[(z*h + y)*w + x] = im(x,y,z);
+
+    vector<float> dtX(w*h), dtY(w*h);
+    for (int i=0; i<iterations; i++) {
+        // the iteration sigmas halve so that the total variance is sigmaDomain^2
+        float sigmaH = sigmaDomain * sqrt(3.0f) * pow(2.0f, float(iterations-i-1))
+                     / sqrt(pow(4.0f, float(iterations)) - 1.0f);
+        float a = exp(-sqrt(2.0f) / sigmaH);
+        for (int j=0; j<w*h; j++) {
+            dtX[j] = pow(a, dx[j]);
+            dtY[j] = pow(a, dy[j]);
+        }
+        domainTransformPass(buf, dtX, w, h, c, true);
+        domainTransformPass(buf, dtY, w, h, c, false);
+    }
+
+    Image out(w, h, c);
+    for (int z=0; z<c; z++)
+    for (int y=0; y<h; y++)
+    for (int x=0; x<w; x++)
+        out(x,y,z) = buf[(z*h + y)*w + x];
+    return out;
+}
+
+Image domainTransformYUV(const Image &im, float sigmaRange, float sigmaY, float sigmaUV, int iterations){
+    // same split as bilaYUV: Y and UV are filtered on their own, both with
+    // edges measured on the full YUV image
+    Image imYUV = rgb2yuv(im);
+    Image Y(im.width(), im.height(), 1), UV(im.width(), im.height(), 2);
+    for (int y=0; y<im.height(); y++)
+    for (int x=0; x<im.width(); x++)
+    {
+        Y(x,y,0)  = imYUV(x,y,0);
+        UV(x,y,0) = imYUV(x,y,1);
+        UV(x,y,1) = imYUV(x,y,2);
+    }
+    Image dtY  = domainTransform(Y, imYUV, sigmaRange, sigmaY, iterations);
+    Image dtUV = domainTransform(UV, imYUV, sigmaRange, sigmaUV, iterations);
+    for (int y=0; y<im.height(); y++)
+    for (int x=0; x<im.width(); x++)
+    {
+        imYUV(x,y,0) = dtY(x,y,0);
+        imYUV(x,y,1) = dtUV(x,y,0);
+        imYUV(x,y,2) = dtUV(x,y,1);
+    }
+    return yuv2rgb(imYUV);
+}
+
+
 /**************************************************************
  //               DON'T EDIT BELOW THIS LINE                //
  *************************************************************/
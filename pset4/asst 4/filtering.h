@@ -65,8 +65,34 @@ Image gaussianBlur_2D(const Image &im, float sigma, float truncate=3.0, bool cla
 Image unsharpMask(const Image &im, float sigma, float truncate=3.0, float strength=1.0, bool clamp=true);
 
 // Bilaterial Filtering
-Image bilateral(const Image &im, float sigmaRange=0.1, float sigmaDomain=1.0, float truncateDomain=3.0, bool clamp=true);
-Image bilaYUV(const Image &im, float sigmaRange=0.1, float sigmaY=1.0, float sigmaUV=4.0, float truncateDomain=3.0, bool clamp=true);
+// fast=true switches to the approximate bilateral grid below
+Image bilateral(const Image &im, float sigmaRange=0.1, float sigmaDomain=1.0, float truncateDomain=3.0, bool clamp=true, bool fast=false);
+Image bilaYUV(const Image &im, float sigmaRange=0.1, float sigmaY=1.0, float sigmaUV=4.0, float truncateDomain=3.0, bool clamp=true, bool fast=false);
+// Straightforward per-tap implementation, kept as the reference for testing
+Image bilateral_reference(const Image &im, float sigmaRange=0.1, float sigmaDomain=1.0, float truncateDomain=3.0, bool clamp=true);
+
+// Fast approximate bilateral filter on a downsampled bilateral grid
+// (splat / blur / slice). The range distance is measured on a single
+// channel guide: the image itself if it is grayscale, its luminance otherwise.
+Image bilateralGrid(const Image &im, float sigmaRange=0.1, float sigmaDomain=1.0);
+Image bilateralGrid(const Image &im, const Image &guide, float sigmaRange=0.1, float sigmaDomain=1.0);
+
+// Mean over a (2*radius+1)^2 window in O(1) per pixel using running sums
+Image boxMean(const Image &im, int radius);
+
+// Guided filter, an edge-aware smoothing whose cost is independent of the
+// radius. eps plays the role of sigmaRange^2. The guide is either single
+// channel or has as many channels as im; without a guide im guides itself.
+Image guidedFilter(const Image &im, int radius, float eps=0.01);
+Image guidedFilter(const Image &im, const Image &guide, int radius, float eps=0.01);
+
+// Domain transform recursive filter, an O(N) edge-aware smoothing with the
+// same sigmaRange/sigmaDomain semantics as bilateral. Each iteration runs
+// one recursive pass along the rows and one along the columns.
+Image domainTransform(const Image &im, float sigmaRange=0.1, float sigmaDomain=1.0, int iterations=3);
+Image domainTransform(const Image &im, const Image &guide, float sigmaRange=0.1, float sigmaDomain=1.0, int iterations=3);
+// Drop-in alternative to bilaYUV
+Image domainTransformYUV(const Image &im, float sigmaRange=0.1, float sigmaY=1.0, float sigmaUV=4.0, int iterations=3);
 
 // Return impulse image of size kxkx1
 Image impulseImg(int k);
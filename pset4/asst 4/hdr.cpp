@@ -132,7 +132,16 @@ Image makeHDR(vector<Image> &imSeq, float epsilonMini, float epsilonMaxi){
  *************************************************************/
 
 
-Image toneMap(const Image &im, float targetBase, float detailAmp, bool useBila, float sigmaRange) {
+Image toneMap(const Image &im, float targetBase, float detailAmp, bool useBila, float sigmaRange, bool fastBila) {
+    ToneMapBase base = TONEMAP_GAUSSIAN;
+    if (useBila) {
+        base = fastBila ? TONEMAP_BILATERAL_GRID : TONEMAP_BILATERAL;
+    }
+    return toneMap(im, targetBase, detailAmp, base, sigmaRange);
+}
+
+
+Image toneMap(const Image &im, float targetBase, float detailAmp, ToneMapBase base, float sigmaRange) {
     // --------- HANDOUT  PS04 ------------------------------
     // tone map an hdr image
     // - Split the image into its luminance-chrominance components.
@@ -143,10 +152,20 @@ Image toneMap(const Image &im, float targetBase, float detailAmp, bool useBila,
     Image log10_lumi = log10Image(lumi_chromi_vect[0]);
     float sigma = max(im.width(), im.height())/50.0;
     Image blurred_log_lumi = log10_lumi;
-    if (useBila){
+    if (base == TONEMAP_BILATERAL || base == TONEMAP_BILATERAL_GRID){
         //perform bilateral blurring on the image
         //Image bilateral(const Image &im, float sigmaRange, float sigmaDomain, float truncateDomain, bool clamp)
-        blurred_log_lumi = bilateral(log10_lumi, sigmaRange, sigma, 3.0);
+        //the grid approximation makes the large spatial sigma affordable on
+        //full resolution images
+        blurred_log_lumi = bilateral(log10_lumi, sigmaRange, sigma, 3.0, true, base == TONEMAP_BILATERAL_GRID);
+    }
+    else if (base == TONEMAP_GUIDED){
+        //the guided filter runs in constant time per pixel whatever sigma is
+        blurred_log_lumi = guidedFilter(log10_lumi, int(ceil(sigma)), sigmaRange*sigmaRange);
+    }
+    else if (base == TONEMAP_DOMAIN_TRANSFORM){
+        //a few linear recursive passes, fast enough for previews
+        blurred_log_lumi = domainTransform(log10_lumi, sigmaRange, sigma);
     }
     else {
         //perform gaussian blurring on the image
@@ -217,7 +236,7 @@ float image_minnonzero(const Image &im) {
     // channels too)
     float min = FLT_MAX;
     for (int i = 0; i < im.number_of_elements(); i++){
-        if (im(i) < min) {
+        if (im(i) != 0 && im(i) < min) {
             min = im(i);
         }
     }
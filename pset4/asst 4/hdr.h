@@ -25,7 +25,17 @@ Image makeHDR(vector<Image> &imSeq, float epsilonMini=0.002, float epsilonMaxi=0
 
 // Tone Mapping
 Image changeGamma(const Image & im, float old_gamma, float new_gamma);
-Image toneMap(const Image &im, float targetBase=100, float detailAmp=3, bool useBila=false, float sigmaRange=0.1);
+Image toneMap(const Image &im, float targetBase=100, float detailAmp=3, bool useBila=false, float sigmaRange=0.1, bool fastBila=false);
+
+// Edge-aware filter used to extract the base layer
+enum ToneMapBase {
+    TONEMAP_GAUSSIAN,        // plain gaussian blur, not edge-aware
+    TONEMAP_BILATERAL,       // exact bilateral filter
+    TONEMAP_BILATERAL_GRID,  // bilateral grid approximation
+    TONEMAP_GUIDED,          // guided filter, radius sigma and eps sigmaRange^2
+    TONEMAP_DOMAIN_TRANSFORM // domain transform recursive filter
+};
+Image toneMap(const Image &im, float targetBase, float detailAmp, ToneMapBase base, float sigmaRange=0.1);
 Image exp10Image(const Image &im);
 Image log10Image(const Image &im);
 float image_minnonzero(const Image &im);
@@ -171,6 +171,27 @@ void testWarpBy1() {
 
 void testWarp() {
     // Overwrote my test in my final gitcommit :(
+
+    // With a single pair of segments, warp is the same mapping as warpBy1,
+    // and both match sampling the mapped point directly
+    Image im(80, 60, 3);
+    for (int i = 0; i < im.number_of_elements(); i++) im(i) = float(rand()) / RAND_MAX;
+    Segment segBefore(Vec2f(20, 15), Vec2f(60, 20));
+    Segment segAfter(Vec2f(25, 40), Vec2f(55, 10));
+    Image warped1 = warpBy1(im, segBefore, segAfter);
+    Image warped = warp(im, vector<Segment>(1, segBefore), vector<Segment>(1, segAfter));
+    float err1 = 0.0f, err = 0.0f;
+    for (int y = 0; y < im.height(); y++)
+    for (int x = 0; x < im.width(); x++)
+    {
+        Vec2f X = segBefore.UVtoX(segAfter.XtoUV(Vec2f(x, y)));
+        for (int z = 0; z < im.channels(); z++) {
+            float ref = interpolateLin(im, X.x, X.y, z, true);
+            err1 = max(err1, fabs(warped1(x, y, z) - ref));
+            err  = max(err, fabs(warped(x, y, z) - ref));
+        }
+    }
+    cout << "warpBy1 max error: " << err1 << ", warp: " << err << endl;
 }
 
 void testMorph() {
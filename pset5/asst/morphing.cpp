@@ -12,6 +12,7 @@
 
 #include <cassert>
 #include "morphing.h"
+#include "remap.h"
 
 using namespace std;
 
@@ -158,17 +159,18 @@ float Segment::distance(Vec2f X) const {
 Image warpBy1(const Image &im, const Segment &segBefore, const Segment &segAfter){
     // --------- HANDOUT  PS03 ------------------------------
     // Warp an entire image according to a pair of segments.
-     // Warp an entire image according to a pair of segments.
-    Image output(im.width(), im.height(), im.channels());
-    for (int a=0; a < im.width(); a++){
-        for (int b=0; b < im.height(); b++){
-            Vec2f uv = segAfter.XtoUV(Vec2f(a,b));
-            Vec2f X = segBefore.UVtoX(uv);
-            for (int c = 0; c < im.channels(); c++){
-                output(a,b,c) = interpolateLin(im, X.x, X.y, c, true);
-            }
+    // The source position only depends on the pixel, compute it once for
+    // all the channels and let remap do the sampling
+    Image mapX(im.width(), im.height(), 1), mapY(im.width(), im.height(), 1);
+    for (int b=0; b < im.height(); b++){
+        for (int a=0; a < im.width(); a++){
+            Vec2f X = segBefore.UVtoX(segAfter.XtoUV(Vec2f(a,b)));
+            mapX(a,b) = X.x;
+            mapY(a,b) = X.y;
         }
-    } 
+    }
+    Image output(im.width(), im.height(), im.channels());
+    remap(im, FieldCoords(mapX, mapY), output, true, REMAP_CLAMP);
     return output;
 }
 
@@ -203,39 +205,44 @@ Image warp(const Image &im, const vector<Segment> &src_segs,
     X’= X + DSUM / weightsum
     destinationlmage(X) = sourceImage(X’)
     */
-    Image output(im.width(), im.height(), im.channels());
-    for (int i = 0; i < im.width(); i++){
-        for (int j = 0; j < im.height(); j++){
-            for (int c = 0; c < im.channels(); c++){
-                Vec2f DSUM = Vec2f(0,0);
-                Vec2f X = Vec2f(i,j);
-                float weightsum = 0;
-                //for eac line PiQi
-                for (int vector = 0; vector < dst_segs.size(); vector++){
-                    Segment dst = dst_segs[vector];
-                    Segment src = src_segs[vector];
-                    // calculate U,V based on Pi Qi
-                    Vec2f uv = dst.XtoUV(Vec2f(i,j));
-                    Vec2f Xi_prime = src.UVtoX(uv);
-
-                    //calculate displacement Di = Xi’ - Xi for this line
-                    Vec2f displacement = subtract(Xi_prime, X);
-
-                    //weight = (fengl~ / (a + dist ))b
-                    float weight = dst.weight(X,a,b,p);
-        
-                    //DSUM += Di * weight
-                    DSUM = add(DSUM, scalarMult(displacement, weight));
-
-                    //weightsum += weight
-                    weightsum += weight;
-                }
-                //X’= X + DSUM / weightsum
-                Vec2f X_prime = add(X, scalarMult(DSUM, 1/weightsum));
-                output(i,j,c) = interpolateLin(im, X_prime.x, X_prime.y, c, true);
+    Image mapX(im.width(), im.height(), 1), mapY(im.width(), im.height(), 1);
+    #pragma omp parallel for
+    for (int j = 0; j < im.height(); j++){
+        for (int i = 0; i < im.width(); i++){
+            Vec2f DSUM = Vec2f(0,0);
+            Vec2f X = Vec2f(i,j);
+            float weightsum = 0;
+            //for each line PiQi
+            for (int vector = 0; vector < dst_segs.size(); vector++){
+                const Segment &dst = dst_segs[vector];
+                const Segment &src = src_segs[vector];
+                // calculate U,V based on Pi Qi
+                Vec2f uv = dst.XtoUV(Vec2f(i,j));
+                Vec2f Xi_prime = src.UVtoX(uv);
+
+                //calculate displacement Di = Xi’ - Xi for this line
+                Vec2f displacement = subtract(Xi_prime, X);
+
+                //weight = (fengl~ / (a + dist ))b
+                float weight = dst.weight(X,a,b,p);
+    
+                //DSUM += Di * weight
+                DSUM = add(DSUM, scalarMult(displacement, weight));
+
+                //weightsum += weight
+                weightsum += weight;
             }
+            //X’= X + DSUM / weightsum
+            Vec2f X_prime = add(X, scalarMult(DSUM, 1/weightsum));
+            mapX(i,j) = X_prime.x;
+            mapY(i,j) = X_prime.y;
         }
     } 
+
+    // destinationImage(X) = sourceImage(X'), sampled once per pixel for
+    // all channels
+    Image output(im.width(), im.height(), im.channels());
+    remap(im, FieldCoords(mapX, mapY), output, true, REMAP_CLAMP);
     return output;
 }
 
@@ -11,6 +11,7 @@
 #include "matrix.h"
 #include "panorama.h"
 #include "blending.h"
+#include "fixedpoint.h"
 #include <iostream>
 #include <cassert>
 #include <ctime>
@@ -283,12 +284,368 @@ void testAutoStitchNCastle() {
     autostitchN(ims, 1).write("./Output/guedelon-autostitchN.png");
 }
 
+// Compare the separable max/min filters with a direct window scan
+void testMaximumFilter() {
+    Image im(61, 47, 2);
+    for (int i = 0; i < im.number_of_elements(); i++) {
+        im(i) = float(rand()) / RAND_MAX - 0.5f;
+    }
+
+    int w = 7, h = 4;
+    Image mx = maximum_filter_rect(im, w, h);
+    Image mn = minimum_filter_rect(im, w, h);
+    int errors = 0;
+    for (int c = 0; c < im.channels(); c++)
+    for (int y = 0; y < im.height(); y++)
+    for (int x = 0; x < im.width(); x++)
+    {
+        float refMax = -FLT_MAX, refMin = FLT_MAX;
+        for (int dy = -h/2; dy <= h - h/2 - 1; dy++)
+        for (int dx = -w/2; dx <= w - w/2 - 1; dx++)
+        {
+            if (x+dx < 0 || x+dx >= im.width() || y+dy < 0 || y+dy >= im.height()) continue;
+            refMax = max(refMax, im(x+dx, y+dy, c));
+            refMin = min(refMin, im(x+dx, y+dy, c));
+        }
+        if (mx(x,y,c) != refMax || mn(x,y,c) != refMin) errors++;
+    }
+    cout << "maximum/minimum filter mismatches: " << errors << endl;
+
+    // sizes below one pixel leave the image unchanged
+    Image same = maximum_filter(im, 0.5f);
+    Image sameRect = minimum_filter_rect(im, 0, -3);
+    errors = 0;
+    for (int i = 0; i < im.number_of_elements(); i++) {
+        if (same(i) != im(i) || sameRect(i) != im(i)) errors++;
+    }
+    cout << "maximum/minimum filter size < 1 mismatches: " << errors << endl;
+}
+
+// The fused Sobel kernel should match convolution with the Sobel Filters
+void testSobelGradients() {
+    Image im(53, 41, 3);
+    for (int i = 0; i < im.number_of_elements(); i++) {
+        im(i) = float(rand()) / RAND_MAX;
+    }
+
+    Filter sobelX(3, 3), sobelY(3, 3);
+    sobelX(0,0) = -1.0; sobelX(2,0) = 1.0;
+    sobelX(0,1) = -2.0; sobelX(2,1) = 2.0;
+    sobelX(0,2) = -1.0; sobelX(2,2) = 1.0;
+    sobelY(0,0) = -1.0; sobelY(1,0) = -2.0; sobelY(2,0) = -1.0;
+    sobelY(0,2) =  1.0; sobelY(1,2) =  2.0; sobelY(2,2) =  1.0;
+    Image refX = sobelX.convolve(im);
+    Image refY = sobelY.convolve(im);
+
+    SobelGradients grad = sobelGradients(im, GRAD_X | GRAD_Y | GRAD_MAGNITUDE | GRAD_TENSOR);
+    float maxErr = 0.0f;
+    for (int y = 0; y < im.height(); y++)
+    for (int x = 0; x < im.width(); x++)
+    {
+        float xx = 0.0f, xy = 0.0f, yy = 0.0f;
+        for (int c = 0; c < im.channels(); c++) {
+            float gx = refX(x,y,c), gy = refY(x,y,c);
+            maxErr = max(maxErr, fabs(grad.x(x,y,c) - gx));
+            maxErr = max(maxErr, fabs(grad.y(x,y,c) - gy));
+            maxErr = max(maxErr, fabs(grad.magnitude(x,y,c) - sqrt(gx*gx + gy*gy)));
+            xx += gx*gx; xy += gx*gy; yy += gy*gy;
+        }
+        maxErr = max(maxErr, fabs(grad.tensor(x,y,0) - xx));
+        maxErr = max(maxErr, fabs(grad.tensor(x,y,1) - xy));
+        maxErr = max(maxErr, fabs(grad.tensor(x,y,2) - yy));
+    }
+    cout << "sobel gradients max error: " << maxErr << endl;
+}
+
+// Laplacian pyramids should collapse back to the input, and the bands of
+// a pyramid the caller holds should match those built from the image
+void testPyramid() {
+    Image im(101, 67, 3);
+    for (int i = 0; i < im.number_of_elements(); i++) {
+        im(i) = float(rand()) / RAND_MAX;
+    }
+
+    Pyramid gauss(im, Pyramid::GAUSSIAN);
+    cout << "gaussian pyramid levels: " << gauss.levels() << ", coarsest "
+         << gauss[gauss.levels()-1].width() << "x" << gauss[gauss.levels()-1].height() << endl;
+
+    Pyramid lap(im, Pyramid::LAPLACIAN, 4);
+    Image rec = lap.collapse();
+    vector<Image> bands = scaledecompN(im, 4), held = scaledecompN(lap);
+    float errHeld = 0.0f;
+    for (int i = 0; i < (int)bands.size(); i++)
+    for (int j = 0; j < bands[i].number_of_elements(); j++)
+        errHeld = max(errHeld, fabs(bands[i](j) - held[i](j)));
+    cout << "bands of a held pyramid max difference: " << errHeld << endl;
+    Image sum = bands[0];
+    for (int i = 1; i < (int)bands.size(); i++) sum = sum + bands[i];
+
+    float errCollapse = 0.0f, errBands = 0.0f;
+    for (int i = 0; i < im.number_of_elements(); i++) {
+        errCollapse = max(errCollapse, fabs(rec(i) - im(i)));
+        errBands    = max(errBands, fabs(sum(i) - im(i)));
+    }
+    cout << "laplacian collapse max error: " << errCollapse << ", bands: " << errBands << endl;
+}
+
+// The tiled convolutions should match a direct per-pixel convolution
+void testTiledConvolution() {
+    Image im(300, 150, 2);
+    for (int i = 0; i < im.number_of_elements(); i++) {
+        im(i) = float(rand()) / RAND_MAX;
+    }
+
+    vector<float> kx = {0.1f, 0.5f, 0.2f, 0.2f};
+    vector<float> ky = {0.3f, 0.3f, 0.1f, 0.2f, 0.1f};
+    vector<float> k2d;
+    for (float b : ky) for (float a : kx) k2d.push_back(a*b);
+    Filter f(k2d, kx.size(), ky.size());
+
+    for (int clamp = 0; clamp < 2; clamp++) {
+        Image tiled = f.convolve(im, clamp);
+        Image sep = convolveSeparable(im, kx, ky, clamp);
+        float errTiled = 0.0f, errSep = 0.0f;
+        for (int z = 0; z < im.channels(); z++)
+        for (int y = 0; y < im.height(); y++)
+        for (int x = 0; x < im.width(); x++)
+        {
+            float ref = 0.0f;
+            for (int j = 0; j < (int)ky.size(); j++)
+            for (int i = 0; i < (int)kx.size(); i++)
+                ref += f(i, j) * im.smartAccessor(x-i+1, y-j+2, z, clamp);
+            errTiled = max(errTiled, fabs(tiled(x,y,z) - ref));
+            errSep   = max(errSep, fabs(sep(x,y,z) - ref));
+        }
+        cout << "tiled convolution (clamp=" << clamp << ") max error: " << errTiled
+             << ", separable: " << errSep << endl;
+    }
+}
+
+// Cached kernels are built once and match the direct computation
+void testKernelCache() {
+    const vector<float> &k1 = cachedGaussKernel(2.0, 3.0);
+    const vector<float> &k2 = cachedGaussKernel(2.0, 3.0);
+    vector<float> direct = gauss1DFilterValues(2.0, 3.0);
+    cout << "kernel cache shared: " << (&k1 == &k2)
+         << ", matches direct: " << (k1 == direct) << endl;
+
+    const Filter &f = cachedGaussFilter(1.5, 3.0, KERNEL_2D);
+    cout << "2D filter cache shared: " << (&f == &cachedGaussFilter(1.5, 3.0, KERNEL_2D)) << endl;
+
+    const vector<int> &fixed = cachedGaussKernelFixed(2.0, 3.0, 14);
+    int sum = 0;
+    for (int v : fixed) sum += v;
+    cout << "fixed-point kernel sum: " << sum << " (expected " << (1 << 14) << ")" << endl;
+}
+
+// Largest difference in LSB between a fixed-point result and the float
+// reference quantized to the same depth
+template <typename T>
+int maxLSBError(const ImageInt<T> &fixed, const Image &ref) {
+    ImageInt<T> q = toFixed<T>(ref);
+    int err = 0;
+    for (long long i = 0; i < q.number_of_elements(); i++) {
+        err = max(err, abs(int(fixed.data()[i]) - int(q.data()[i])));
+    }
+    return err;
+}
+
+template <typename T>
+void testIntegerPipelineDepth(const Image &im, const string &name) {
+    ImageInt<T> fixed = toFixed<T>(im);
+    // the float reference runs on the same quantized input
+    Image in = toFloat(fixed);
+
+    Image gradRef = gradientMagnitude(in) / 4.0f;
+    Image uvRef = rgb2yuv(in);
+    for (int y = 0; y < im.height(); y++)
+    for (int x = 0; x < im.width(); x++)
+    {
+        uvRef(x, y, 1) = uvRef(x, y, 1) * 0.5f/0.436f + 0.5f;
+        uvRef(x, y, 2) = uvRef(x, y, 2) * 0.5f/0.615f + 0.5f;
+    }
+    ImageInt<T> yuv = rgb2yuvInt(fixed);
+
+    // float yuv2rgb of the same stored chroma
+    Image yuvIn = toFloat(yuv);
+    for (int y = 0; y < im.height(); y++)
+    for (int x = 0; x < im.width(); x++)
+    {
+        yuvIn(x, y, 1) = (yuvIn(x, y, 1) - 0.5f) * 2.0f*0.436f;
+        yuvIn(x, y, 2) = (yuvIn(x, y, 2) - 0.5f) * 2.0f*0.615f;
+    }
+
+    cout << name << " blur: "    << maxLSBError(gaussianBlurInt(fixed, 2.0f), gaussianBlur_separable(in, 2.0f))
+         << " LSB, box: "        << maxLSBError(boxBlurInt(fixed, 5), boxBlur(in, 5))
+         << " LSB, sobel: "      << maxLSBError(gradientMagnitudeInt(fixed), gradRef)
+         << " LSB, unsharp: "    << maxLSBError(unsharpMaskInt(fixed, 2.0f, 3.0f, 1.5f), unsharpMask(in, 2.0f, 3.0f, 1.5f))
+         << " LSB, rgb2yuv: "    << maxLSBError(yuv, uvRef)
+         << " LSB, yuv2rgb: "    << maxLSBError(yuv2rgbInt(yuv), yuv2rgb(yuvIn))
+         << " LSB" << endl;
+}
+
+// 8 and 16-bit fixed-point kernels against the float pipeline
+void testIntegerPipeline() {
+    // smooth random texture with a sharp edge
+    Image im(257, 131, 3);
+    for (int i = 0; i < im.number_of_elements(); i++) {
+        im(i) = float(rand()) / RAND_MAX;
+    }
+    im = gaussianBlur_separable(im, 1.5f);
+    for (int z = 0; z < im.channels(); z++)
+    for (int y = 0; y < im.height(); y++)
+    for (int x = im.width()/2; x < im.width(); x++)
+    {
+        im(x, y, z) = min(im(x, y, z) + 0.4f, 1.0f);
+    }
+
+    testIntegerPipelineDepth<uint8_t>(im, "8-bit");
+    testIntegerPipelineDepth<uint16_t>(im, "16-bit");
+
+    Image8 im8 = toFixed<uint8_t>(im);
+    clock_t start = clock();
+    for (int i = 0; i < 10; i++) gaussianBlurInt(im8, 2.0f);
+    float tInt = float(clock() - start) / CLOCKS_PER_SEC;
+    start = clock();
+    for (int i = 0; i < 10; i++) gaussianBlur_separable(im, 2.0f);
+    float tFloat = float(clock() - start) / CLOCKS_PER_SEC;
+    cout << "8-bit blur time: " << tInt << "s, float: " << tFloat << "s" << endl;
+}
+
+
+// The fused unsharp mask against the unfused formula, then its threshold
+// and overshoot clamp
+void testUnsharpMaskFused() {
+    Image im(211, 97, 3);
+    for (int i = 0; i < im.number_of_elements(); i++) {
+        im(i) = float(rand()) / RAND_MAX;
+    }
+    im = gaussianBlur_separable(im, 1.0f);
+
+    Image lowPass = gaussianBlur_separable(im, 2.0f);
+    Image ref = im + 1.5f*(im - lowPass);
+    Image fused = unsharpMask(im, 2.0f, 3.0f, 1.5f);
+    float err = 0.0f;
+    for (int i = 0; i < im.number_of_elements(); i++) {
+        err = max(err, fabs(fused(i) - ref(i)));
+    }
+    cout << "fused unsharp mask max error: " << err << endl;
+
+    Image thresh = unsharpMask(im, 2.0f, 3.0f, 1.5f, true, 0.05f);
+    int untouched = 0, wrong = 0;
+    for (int i = 0; i < im.number_of_elements(); i++) {
+        bool low = fabs(im(i) - lowPass(i)) < 0.05f;
+        untouched += low;
+        wrong += low ? thresh(i) != im(i) : thresh(i) != fused(i);
+    }
+    cout << "thresholded pixels: " << untouched << ", mismatches: " << wrong << endl;
+
+    Image clamped = unsharpMask(im, 2.0f, 3.0f, 1.5f, true, 0.0f, 0.01f);
+    float excess = 0.0f;
+    for (int z = 0; z < im.channels(); z++)
+    for (int y = 0; y < im.height(); y++)
+    for (int x = 0; x < im.width(); x++)
+    {
+        float lo = im(x, y, z), hi = lo;
+        for (int dy = -1; dy <= 1; dy++)
+        for (int dx = -1; dx <= 1; dx++)
+        {
+            lo = min(lo, im.smartAccessor(x+dx, y+dy, z, true));
+            hi = max(hi, im.smartAccessor(x+dx, y+dy, z, true));
+        }
+        excess = max(excess, max(lo - 0.01f - clamped(x, y, z), clamped(x, y, z) - hi - 0.01f));
+    }
+    cout << "overshoot beyond the clamp: " << excess << endl;
+}
+
+// The remap wrappers against the per-pixel formulas they replace
+void testRemap() {
+    Image im(90, 60, 3);
+    for (int i = 0; i < im.number_of_elements(); i++) {
+        im(i) = float(rand()) / RAND_MAX;
+    }
+
+    float theta = 0.4f;
+    float cx = (im.width()-1.0)/2.0, cy = (im.height()-1.0)/2.0;
+    Image rot = rotate(im, theta);
+    float errRot = 0.0f;
+    for (int z = 0; z < im.channels(); z++)
+    for (int y = 0; y < im.height(); y++)
+    for (int x = 0; x < im.width(); x++)
+    {
+        float xR = (x - cx)*cos(theta) + (cy - y)*sin(theta) + cx;
+        float yR = cy - ( -(x - cx)*sin(theta) + (cy - y)*cos(theta) );
+        errRot = max(errRot, fabs(rot(x,y,z) - interpolateLin(im, xR, yR, z)));
+    }
+    cout << "remap rotate max error: " << errRot << endl;
+
+    Matrix H(3, 3);
+    H << 0.9, 0.1, 12,
+        -0.05, 1.1, 5,
+         0.0005, 0.0002, 1;
+    Matrix invH = H.inverse();
+    Image weight(im.width(), im.height(), 1);
+    for (int i = 0; i < weight.number_of_elements(); i++) weight(i) = float(rand()) / RAND_MAX;
+
+    Image outLin(120, 90, 3), outNN(120, 90, 3), outBlend(120, 90, 3);
+    outBlend = outBlend + 0.25f;
+    applyHomography(im, H, outLin, true);
+    applyHomography(im, H, outNN, false);
+    applyhomographyBlend(im, weight, outBlend, H, true);
+    float errLin = 0.0f, errNN = 0.0f, errBlend = 0.0f;
+    for (int z = 0; z < outLin.channels(); z++)
+    for (int y = 0; y < outLin.height(); y++)
+    for (int x = 0; x < outLin.width(); x++)
+    {
+        Vec3f p = invH * Vec3f(x, y, 1);
+        float sx = p(0)/p(2), sy = p(1)/p(2);
+        // the two computations may round differently right on the border
+        float margin = min(min(fabs(sx), fabs(sy)), min(fabs(sx - im.width()+1), fabs(sy - im.height()+1)));
+        if (margin < 1e-4f) continue;
+        float lin = 0.0f, nn = 0.0f, blend = 0.25f;
+        if (sx >= 0 && sy >= 0 && sx < im.width()-1 && sy < im.height()-1) {
+            lin = interpolateLin(im, sx, sy, z, false);
+            nn = im(round(sx), round(sy), z);
+            blend += weight(int(sx), int(sy)) * lin;
+        }
+        errLin = max(errLin, fabs(outLin(x,y,z) - lin));
+        // rounding at exactly half a pixel may pick the other neighbor
+        errNN += fabs(outNN(x,y,z) - nn) > 1e-6f;
+        errBlend = max(errBlend, fabs(outBlend(x,y,z) - blend));
+    }
+    cout << "remap homography max error: " << errLin << ", nearest mismatches: " << errNN
+         << ", blend max error: " << errBlend << endl;
+
+    Image planet = pano2planet(im, 80);
+    float errPlanet = 0.0f;
+    for (int z = 0; z < planet.channels(); z++)
+    for (int y = 0; y < planet.height(); y++)
+    for (int x = 0; x < planet.width(); x++)
+    {
+        float dx = x - planet.width()/2, dy = y - planet.height()/2;
+        float angle = atan2(dy, dx);
+        if (angle < 0) angle += 2*M_PI;
+        float sx = im.width() - angle/(2*M_PI)*im.width();
+        float sy = im.height() - 2*sqrt(dx*dx + dy*dy)*im.height()/planet.height();
+        errPlanet = max(errPlanet, fabs(planet(x,y,z) - interpolateLin(im, sx, sy, z, true)));
+    }
+    cout << "remap pano2planet max error: " << errPlanet << endl;
+}
 
 // This is a way for you to test your functions. 
 // We will only grade the contents of panorama.cpp
 int main() {
     srand(0); // Fixed seed for deterministic results
 
+    testMaximumFilter();
+    testSobelGradients();
+    testPyramid();
+    testTiledConvolution();
+    testKernelCache();
+    testIntegerPipeline();
+    testUnsharpMaskFused();
+    testRemap();
+
     // Part 1/2 tests
     /*
     testComputeTensor();
@@ -9,6 +9,8 @@
 
 
 #include "basicImageManipulation.h"
+#include "resample.h"
+#include "remap.h"
 using namespace std;
 
 // --------- HANDOUT PS01 ------------------------------
@@ -365,26 +367,16 @@ Image scaleLin(const Image &im, float factor){
     // return im;
     
     // --------- SOLUTION PS05 ------------------------------
-    float ys, xs; // coordinate in the source image
-
 	// Initialize a new Image factor times bigger (or smaller if factor <1)
     int nWidth  = floor(factor*im.width());
     int nHeight = floor(factor*im.height());
-    Image im2(nWidth, nHeight, im.channels());
-    
-    // For each pixel in the output
-    for (int z=0; z<im.channels(); z++) 
-    for (int y=0; y<nHeight; y++) 
-    for (int x=0; x<nWidth; x++) 
-    {
-        // Get the source pixel value.
-        ys = 1/factor * y;
-        xs = 1/factor * x;
-        im2(x,y,z) = interpolateLin(im, xs, ys, z);
-    }
-    
-	// return new image
-    return im2;
+
+    // Output pixel (x,y) samples the source at (x,y)/factor. The bilinear
+    // weights are computed once per row and per column, and the kernel is
+    // widened when shrinking so that it also prefilters.
+    ResampleTable tx = resampleTable(im.width(),  nWidth,  RESAMPLE_BILINEAR, 1/factor, 0.0f);
+    ResampleTable ty = resampleTable(im.height(), nHeight, RESAMPLE_BILINEAR, 1/factor, 0.0f);
+    return resampleSeparable(im, tx, ty);
 }
 
 
@@ -403,26 +395,13 @@ Image rotate(const Image &im, float theta) {
 	// center around which to rotate
     float centerX = (im.width()-1.0)/2.0;
     float centerY = (im.height()-1.0)/2.0;
-    
-    
-	// get new image
-    Image imR(im.width(), im.height(), im.channels());
-    
-    // For each pixel in the output
-    float yR, xR; // rotated coordinates
-    for (int x=0; x<im.width(); x++) 
-    for (int y=0; y<im.height(); y++) 
-    for (int z=0; z<im.channels(); z++) 
-    {
-        
-        // compute the x and y values from the original image
-        xR = (static_cast<float>(x) - centerX)*cos(theta) + (centerY - static_cast<float>(y))*sin(theta) + centerX;
-        yR = centerY - ( -(static_cast<float>(x) - centerX)*sin(theta) + (centerY - static_cast<float>(y))*cos(theta) );
-
-        // interpolate the point
-        imR(x,y,z) = interpolateLin(im, xR, yR, z);
-    }
+    float c = cos(theta), s = sin(theta);
 
+    // source of (x,y): rotation by theta around the center
+    const float m[6] = {c, -s, -centerX*c + centerY*s + centerX,
+                        s,  c,  centerY - centerX*s - centerY*c};
+    Image imR(im.width(), im.height(), im.channels());
+    remap(im, AffineCoords(m), imR, true, REMAP_BLACK);
     return imR; 
 }
 
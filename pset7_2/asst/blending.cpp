@@ -25,47 +25,7 @@ Image blendingweight(int imwidth, int imheight) {
 // so out(x,y) = out(x, y) + weight * image
 void applyhomographyBlend(const Image &source, const Image &weight, Image &out, Matrix &H, bool bilinear) {
     // // --------- HANDOUT  PS07 ------------------------------
-
-    Matrix inv_H = H.inverse();
-
-    cout << "TODO: WEIRD IMAGE BOUNDS THING " << endl;
-
-    cout << "weight image width: " << weight.width() << " height: " << weight.height() << endl;
-
-    cout << "out image width: " << out.width() << " height: " << out.height() << endl;
-
-
-    for (int a = 0; a < out.width(); a++){
-        for (int b = 0; b < out.height(); b++){
-            for (int c = 0; c < out.channels(); c++){
-                
-                Matrix homographic_points = Matrix(3,1);
-                homographic_points(0,0) = a;
-                homographic_points(1,0) = b;
-                homographic_points(2,0) = 1;
-
-                Matrix soln = inv_H * homographic_points;
-
-                float new_x = soln(0,0)/soln(2,0);
-                float new_y = soln(1,0)/soln(2,0);
-
-                if (new_x >= 0 && new_y >= 0 && new_x < source.width() - 1 && new_y < source.height() - 1){
-                    float pixel_value;
-                    if (bilinear){
-                        pixel_value = interpolateLin(source, new_x, new_y, c, false);
-                        //interpolateLin(const Image &im, float x, float y, int z, bool clamp)
-                    }
-                    else {
-                        pixel_value = source(round(new_x), round(new_y), c);
-                    }
-
-                    out(a, b, c) = out(a, b, c) + weight(new_x, new_y) * pixel_value;
-
-                }
-
-            }
-        }
-    }
+    remap(source, homographyCoords(H), out, bilinear, REMAP_SKIP, &weight);
 }
 
 
@@ -165,6 +125,23 @@ vector<Image> scaledecomp(const Image &im, float sigma) {
     return ims;
 }
 
+vector<Image> scaledecompN(const Image &im, int levels) {
+    return scaledecompN(Pyramid(im, Pyramid::LAPLACIAN, levels));
+}
+
+vector<Image> scaledecompN(const Pyramid &lap) {
+    vector<Image> bands;
+    for (int i = 0; i < lap.levels(); i++) {
+        // expand through the intermediate sizes so the bands sum exactly
+        Image band = lap.level(i);
+        for (int j = i-1; j >= 0; j--) {
+            band = pyrUp(band, lap.level(j).width(), lap.level(j).height());
+        }
+        bands.push_back(band);
+    }
+    return bands;
+}
+
 // stitch using different blending models
 // blend can be 0 (none), 1 (linear) or 2 (2-layer)
 Image stitchBlending(Image &im1, Image &im2, Matrix H, int blend) {
@@ -383,81 +360,14 @@ Image pano2planet(const Image &pano, int newImSize, bool clamp) {
 
     */
 
+    // The center of the output is the bottom of the panorama, and the
+    // middle of its right edge the top. The angle sweeps the panorama from
+    // its right end, counter-clockwise.
     Image new_img(newImSize, newImSize, pano.channels());
-    Image polar_coords_im = new_img;
-    for (int i = 0; i < new_img.width(); i++){
-        for (int j = 0; j < new_img.height(); j++){
-            float x_from_center = i - new_img.width()/2;
-            float y_from_center = j - new_img.height()/2;
-            
-            float radius = pow(x_from_center*x_from_center + y_from_center*y_from_center, .5);
-            polar_coords_im(i,j,0) = radius;
-
-            float angle = atan2(y_from_center, x_from_center);
-            polar_coords_im(i,j,1) = angle;
-        }
-    }
-
-    /*
-    Map the bottom of your input panorama to the center of 
-    the the new image and the top to a radius corresponding
-    to the distance between the center and the right edge (in the square output).
-
-    --> as you go bottom to top, radius increases...
-
-    The left and right sides of the input panorama should be mapped to
-    an angle of 0, along the right horizontal axis in the new image with
-    increasing (counter-clockwise) angle in the output corresponding to
-    sweeping from left to right of the input panorama. 
-
-    -> as you move left to right, angle increases...
-    
-    Idea:
-    Iterate through polar coords of new image.
-    For each (radius, angle), convert to x y coords for the initial image
-    How?
-    For radius --> center and right edge, make it a ratio, so...
-        - start with new image thing, get radius,
-        - multiply by height of  old image/2, divide by right edge of square output (newImsize/2)
-        - that's our y coord
-
-    For angle --> The left and right sides of the input panorama should be mapped to
-    an angle of 0
-        - start with new image, get angle
-        - divide angle by 2pi (need to check if it's negative? and if so add 2pi)
-        - multiply by width = sweeping from left to right
-        - use that as index.
-    */
-
-    for (int i = 0; i < polar_coords_im.width(); i++){
-        for (int j = 0; j < polar_coords_im.height(); j++){
-            float radius = polar_coords_im(i,j,0);
-            float mapped_radius = pano.height() - 2*radius*pano.height()/polar_coords_im.height();
-            float angle = polar_coords_im(i,j,1);
-            if (angle < 0){
-                angle = angle + 2*M_PI;
-            }
-            float mapped_angle = pano.width() - angle/(2*M_PI)*pano.width();
-            
-            if (i == polar_coords_im.width()/2 && j == polar_coords_im.height()/2){
-                cout << "At center of polar coords image. x is: " << mapped_angle << " y is: " << mapped_radius << " and the original width/height is: (" << pano.width() << " , " << pano.height() << ")" << endl;
-            }
-
-            if (i == polar_coords_im.width() - 1 && j == polar_coords_im.height()/2){
-                cout << "At right center of polar coords image. Should be top of pano. x pano is: " << mapped_angle << " y is: " << mapped_radius << " and the original width/height is: (" << pano.width() << " , " << pano.height() << ")" << endl;
-            }
-
-            if (i == polar_coords_im.width() - 1 && j == polar_coords_im.height()/2){
-                cout << "At right center of polar coords image. Should be top of pano. x pano is: " << mapped_angle << " y is: " << mapped_radius << " and the original width/height is: (" << pano.width() << " , " << pano.height() << ")" << endl;
-            }
-
-            for (int c = 0; c < new_img.channels(); c++){
-                float pixel_value = interpolateLin(pano, mapped_angle, mapped_radius, c, true);
-                new_img(i,j,c) = pixel_value;   
-            }
-        }
-    }
-
+    PolarCoords polar(newImSize/2, newImSize/2,
+                      -pano.width()/(2*M_PI), pano.width(),
+                      -2.0f*pano.height()/newImSize, pano.height());
+    remap(pano, polar, new_img, true, clamp ? REMAP_CLAMP : REMAP_BLACK);
     return new_img;
 }
 
@@ -16,6 +16,7 @@
 #include "filtering.h"
 #include "homography.h"
 #include "panorama.h"
+#include "pyramid.h"
 #include "basicImageManipulation.h"
 #include <iostream>
 #include <cmath>
@@ -31,6 +32,11 @@ Image blendingweight(int imwidth, int imheight);
 void applyhomographyBlend(const Image &source, const Image &weight, Image &out, Matrix &H, bool bilinear=false);
 Image stitchLinearBlending(const Image &im1, const Image &im2, const Image &we1, const Image &we2, Matrix H);
 vector<Image> scaledecomp(const Image &im, float sigma = 2.0);
+// Laplacian bands of im, each brought back to full resolution, finest
+// first. They sum to im. The second version reuses a Laplacian pyramid the
+// caller already holds.
+vector<Image> scaledecompN(const Image &im, int levels = 4);
+vector<Image> scaledecompN(const Pyramid &lap);
 Image stitchBlending(Image &im1, Image &im2, Matrix H, int blend);
 Image autostitch(Image &im1, Image &im2, int blend, float blurDescriptor=0.5, float radiusDescriptor=4);
 
@@ -11,6 +11,9 @@
 #include "filtering.h"
 #include <cmath>
 #include <cassert>
+#include <algorithm>
+#include <map>
+#include <mutex>
 
 using namespace std;
 
@@ -46,39 +49,127 @@ Image boxBlur(const Image &im, int k, bool clamp) {
     return filtered;
 }
 
-Image Filter::convolve(const Image &im, bool clamp){
+// Output tiles of the convolution engine. A tile row of floats plus the
+// halo and the ring buffer of the separable path stay well within L2.
+static const int CONV_TILE_W = 256;
+static const int CONV_TILE_H = 64;
+
+Image Filter::convolve(const Image &im, bool clamp) const {
     // // --------- HANDOUT  PS02 ------------------------------
     // // Write a convolution function for the filter class
     // return im; // change this
     
-    // --------- SOLUTION PS02 ------------------------------
     Image imFilter(im.width(), im.height(), im.channels());
     
     int sideW = int((width-1.0)/2.0);
     int sideH = int((height-1.0)/2.0);
-    float accum;
-    
-    // for every pixel in the image
-    for (int z = 0; z < imFilter.channels(); z++) 
-    for (int y = 0; y < imFilter.height(); y++) 
-    for (int x = 0; x < imFilter.width(); x++) 
-    {
-        accum = 0.0;
-        for (int yFilter=0; yFilter<height; yFilter++)
-        for (int xFilter=0; xFilter<width; xFilter++)
+    // extent of the flipped kernel before the current pixel
+    int haloW = width-1-sideW;
+    int haloH = height-1-sideH;
+
+    int nTilesX = (im.width() + CONV_TILE_W - 1) / CONV_TILE_W;
+    int nTilesY = (im.height() + CONV_TILE_H - 1) / CONV_TILE_H;
+
+    // every tile gathers its input window once (with the border handled
+    // by smartAccessor) and convolves from that local buffer
+    #pragma omp parallel for schedule(dynamic)
+    for (int t = 0; t < nTilesX*nTilesY*im.channels(); t++) {
+        int z  = t / (nTilesX*nTilesY);
+        int x0 = (t % nTilesX) * CONV_TILE_W;
+        int y0 = ((t / nTilesX) % nTilesY) * CONV_TILE_H;
+        int tw = min(CONV_TILE_W, im.width() - x0);
+        int th = min(CONV_TILE_H, im.height() - y0);
+        int bw = tw + width - 1;
+        int bh = th + height - 1;
+
+        vector<float> window(bw*bh);
+        for (int j = 0; j < bh; j++)
+        for (int i = 0; i < bw; i++)
+            window[j*bw + i] = im.smartAccessor(x0 - haloW + i, y0 - haloH + j, z, clamp);
+
+        for (int y = 0; y < th; y++)
+        for (int x = 0; x < tw; x++)
         {
-            // sum the image pixel values weighted by the filter
-            // flipped kernel, xFilter, yFilter have different signs in filter
-            // and im
-            accum += operator()(xFilter, yFilter) * im.smartAccessor(x-xFilter+sideW,y-yFilter+sideH,z,clamp);
+            float accum = 0.0f;
+            for (int yFilter=0; yFilter<height; yFilter++) {
+                // flipped kernel, xFilter, yFilter have different signs in
+                // filter and im
+                const float *row = &window[(y + height-1-yFilter)*bw + x + width-1];
+                const float *k   = &kernel[yFilter*width];
+                for (int xFilter=0; xFilter<width; xFilter++) {
+                    accum += k[xFilter] * row[-xFilter];
+                }
+            }
+            imFilter(x0+x, y0+y, z) = accum;
+        }
+    }
+    return imFilter;
+}
+
+
+// Tiled separable convolution shared by convolveSeparable and the fused
+// unsharp mask. Each tile keeps only the m most recent horizontally filtered
+// rows in a ring buffer instead of a full size intermediate image, and
+// every filtered value goes through epilogue(x, y, z, value) before being
+// stored, so pointwise post-processing costs no extra buffer.
+template <typename Epilogue>
+static Image separableTiles(const Image &im, const vector<float> &kx, const vector<float> &ky, bool clamp, Epilogue epilogue){
+    Image imFilter(im.width(), im.height(), im.channels());
+
+    int n = kx.size(), m = ky.size();
+    int sideX = (n-1)/2, sideY = (m-1)/2;
+    int haloX = n-1-sideX, haloY = m-1-sideY;
+
+    int nTilesX = (im.width() + CONV_TILE_W - 1) / CONV_TILE_W;
+    int nTilesY = (im.height() + CONV_TILE_H - 1) / CONV_TILE_H;
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int t = 0; t < nTilesX*nTilesY*im.channels(); t++) {
+        int z  = t / (nTilesX*nTilesY);
+        int x0 = (t % nTilesX) * CONV_TILE_W;
+        int y0 = ((t / nTilesX) % nTilesY) * CONV_TILE_H;
+        int tw = min(CONV_TILE_W, im.width() - x0);
+        int th = min(CONV_TILE_H, im.height() - y0);
+
+        vector<float> line(tw + n - 1);
+        vector<float> ring(m*tw);
+
+        // horizontal pass of input row yy into its ring slot
+        auto filterRow = [&](int yy) {
+            for (int i = 0; i < tw + n - 1; i++)
+                line[i] = im.smartAccessor(x0 - haloX + i, yy, z, clamp);
+            float *slot = &ring[(((yy % m) + m) % m)*tw];
+            for (int x = 0; x < tw; x++) {
+                float accum = 0.0f;
+                const float *in = &line[x + n-1];
+                for (int k = 0; k < n; k++) accum += kx[k] * in[-k];
+                slot[x] = accum;
+            }
+        };
+
+        for (int yy = y0 - haloY; yy < y0 + sideY; yy++) filterRow(yy);
+
+        for (int y = y0; y < y0 + th; y++) {
+            filterRow(y + sideY);
+            for (int x = 0; x < tw; x++) {
+                float accum = 0.0f;
+                for (int k = 0; k < m; k++) {
+                    int yy = y - k + sideY;
+                    accum += ky[k] * ring[(((yy % m) + m) % m)*tw + x];
+                }
+                imFilter(x0+x, y, z) = epilogue(x0+x, y, z, accum);
+            }
         }
-        
-        // assign the pixel the value from convolution
-        imFilter(x,y,z) = accum;
     }
     return imFilter;
 }
 
+Image convolveSeparable(const Image &im, const vector<float> &kx, const vector<float> &ky, bool clamp){
+    // Equivalent to convolving with Filter(kx, n, 1) then Filter(ky, 1, m).
+    return separableTiles(im, kx, ky, clamp,
+        [](int, int, int, float v) { return v; });
+}
+
 
 
 Image boxBlur_filterClass(const Image &im, int k, bool clamp) {
@@ -100,31 +191,63 @@ Image gradientMagnitude(const Image &im, bool clamp){
     // Uses a Sobel kernel to compute the horizontal and vertical
     // components of the gradient of an image and returns the gradient magnitude.
     
-    // --------- SOLUTION PS02 ------------------------------
-    // sobel filtering in x direction
-    Filter sobelX(3, 3);
-    sobelX(0,0) = -1.0; sobelX(1,0) = 0.0; sobelX(2,0) = 1.0;
-    sobelX(0,1) = -2.0; sobelX(1,1) = 0.0; sobelX(2,1) = 2.0;
-    sobelX(0,2) = -1.0; sobelX(1,2) = 0.0; sobelX(2,2) = 1.0;
-
-    Image imSobelX = sobelX.convolve(im, clamp);
-    
-    // sobel filtering in y direction
-    Filter sobelY(3, 3);
-    sobelY(0,0) = -1.0; sobelY(1,0) = -2.0; sobelY(2,0) = -1.0;
-    sobelY(0,1) =  0.0; sobelY(1,1) =  0.0; sobelY(2,1) =  0.0;
-    sobelY(0,2) =  1.0; sobelY(1,2) =  2.0; sobelY(2,2) =  1.0;
-    Image imSobelY = sobelY.convolve(im, clamp);
-    
-    // squared magnitude
-    Image magnitude = imSobelX*imSobelX + imSobelY*imSobelY;
-    
-    // take the square root
-    for(int i=0; i<magnitude.number_of_elements(); i++ ){
-        magnitude(i) = sqrt(magnitude(i));
+    // both sobel responses, squared magnitude and square root in one pass
+    return sobelGradients(im, GRAD_MAGNITUDE, clamp).magnitude;
+}
+
+
+SobelGradients::SobelGradients()
+    : x(1,1,1), y(1,1,1), magnitude(1,1,1), orientation(1,1,1), tensor(1,1,1) {}
+
+
+SobelGradients sobelGradients(const Image &im, int outputs, bool clamp){
+    int w = im.width(), h = im.height(), nc = im.channels();
+    int pw = w + 2;
+
+    SobelGradients grad;
+    if (outputs & GRAD_X)           grad.x           = Image(w, h, nc);
+    if (outputs & GRAD_Y)           grad.y           = Image(w, h, nc);
+    if (outputs & GRAD_MAGNITUDE)   grad.magnitude   = Image(w, h, nc);
+    if (outputs & GRAD_ORIENTATION) grad.orientation = Image(w, h, nc);
+    if (outputs & GRAD_TENSOR)      grad.tensor      = Image(w, h, 3);
+
+    // one channel plane at a time, padded by one pixel like smartAccessor
+    vector<float> padded(pw*(h+2));
+    for (int z = 0; z < nc; z++) {
+        for (int y = -1; y <= h; y++)
+        for (int x = -1; x <= w; x++)
+            padded[(y+1)*pw + x+1] = im.smartAccessor(x, y, z, clamp);
+
+        // tiles of rows are independent
+        #pragma omp parallel for schedule(static, 32)
+        for (int y = 0; y < h; y++) {
+            const float *r0 = &padded[y*pw];     // row above
+            const float *r1 = &padded[(y+1)*pw]; // center row
+            const float *r2 = &padded[(y+2)*pw]; // row below
+            vector<float> gx(w), gy(w);
+
+            // same orientation as convolving with the flipped kernels of
+            // gradientX and gradientY: previous minus next sample
+            for (int x = 0; x < w; x++) {
+                gx[x] = (r0[x] - r0[x+2]) + 2.0f*(r1[x] - r1[x+2]) + (r2[x] - r2[x+2]);
+                gy[x] = (r0[x] + 2.0f*r0[x+1] + r0[x+2]) - (r2[x] + 2.0f*r2[x+1] + r2[x+2]);
+            }
+
+            for (int x = 0; x < w; x++) {
+                if (outputs & GRAD_X)           grad.x(x, y, z) = gx[x];
+                if (outputs & GRAD_Y)           grad.y(x, y, z) = gy[x];
+                if (outputs & GRAD_MAGNITUDE)   grad.magnitude(x, y, z) = sqrt(gx[x]*gx[x] + gy[x]*gy[x]);
+                if (outputs & GRAD_ORIENTATION) grad.orientation(x, y, z) = atan2(gy[x], gx[x]);
+                if (outputs & GRAD_TENSOR) {
+                    // summed over the channels
+                    grad.tensor(x, y, 0) += gx[x]*gx[x];
+                    grad.tensor(x, y, 1) += gx[x]*gy[x];
+                    grad.tensor(x, y, 2) += gy[x]*gy[x];
+                }
+            }
+        }
     }
-    
-    return magnitude;
+    return grad;
 }
 
 vector<float> gauss1DFilterValues(float sigma, float truncate){
@@ -155,6 +278,72 @@ vector<float> gauss1DFilterValues(float sigma, float truncate){
     return fData;
 }
 
+// ------------- KERNEL CACHE -----------------------
+// Kernels are keyed by (sigma, truncate, shape) and built once. The maps
+// are node based, so the returned references stay valid while the cache
+// grows; the mutex only guards lookup and insertion.
+struct KernelKey {
+    float sigma, truncate;
+    int shape; // KernelShape, or the number of fractional bits
+    bool operator<(const KernelKey &o) const {
+        if (sigma != o.sigma) return sigma < o.sigma;
+        if (truncate != o.truncate) return truncate < o.truncate;
+        return shape < o.shape;
+    }
+};
+
+static mutex kernelCacheMutex;
+
+const vector<float> & cachedGaussKernel(float sigma, float truncate, KernelShape shape){
+    static map<KernelKey, vector<float> > cache;
+    KernelKey key = {sigma, truncate, shape};
+    lock_guard<mutex> lock(kernelCacheMutex);
+    auto it = cache.find(key);
+    if (it == cache.end()) {
+        vector<float> fData = shape == KERNEL_2D ? gauss2DFilterValues(sigma, truncate)
+                                                 : gauss1DFilterValues(sigma, truncate);
+        it = cache.insert(make_pair(key, fData)).first;
+    }
+    return it->second;
+}
+
+const Filter & cachedGaussFilter(float sigma, float truncate, KernelShape shape){
+    static map<KernelKey, Filter> cache;
+    const vector<float> &fData = cachedGaussKernel(sigma, truncate, shape);
+    KernelKey key = {sigma, truncate, shape};
+    lock_guard<mutex> lock(kernelCacheMutex);
+    auto it = cache.find(key);
+    if (it == cache.end()) {
+        // 2D filters are k x k, 1D filters are horizontal
+        int k = shape == KERNEL_2D ? int(sqrt(fData.size()) + 0.5) : fData.size();
+        Filter filter = shape == KERNEL_2D ? Filter(fData, k, k) : Filter(fData, k, 1);
+        it = cache.insert(make_pair(key, filter)).first;
+    }
+    return it->second;
+}
+
+const vector<int> & cachedGaussKernelFixed(float sigma, float truncate, int fracBits){
+    static map<KernelKey, vector<int> > cache;
+    const vector<float> &fData = cachedGaussKernel(sigma, truncate, KERNEL_1D);
+    KernelKey key = {sigma, truncate, fracBits};
+    lock_guard<mutex> lock(kernelCacheMutex);
+    auto it = cache.find(key);
+    if (it == cache.end()) {
+        // round every tap, then give the rounding residual to the center tap
+        // so that the taps sum to exactly 1 << fracBits
+        vector<int> fixed(fData.size());
+        int sum = 0;
+        for (int i = 0; i < (int)fData.size(); i++) {
+            fixed[i] = int(fData[i] * (1 << fracBits) + 0.5f);
+            sum += fixed[i];
+        }
+        fixed[fData.size()/2] += (1 << fracBits) - sum;
+        it = cache.insert(make_pair(key, fixed)).first;
+    }
+    return it->second;
+}
+// --------- END KERNEL CACHE -----------------------
+
 Image gaussianBlur_horizontal(const Image &im, float sigma, float truncate, bool clamp){
     // // --------- HANDOUT  PS02 ------------------------------
     // // Gaussian blur across the rows of an image
@@ -162,10 +351,8 @@ Image gaussianBlur_horizontal(const Image &im, float sigma, float truncate, bool
     
     // --------- SOLUTION PS02 ------------------------------
     // filter in the x direction
-    vector<float> fData = gauss1DFilterValues(sigma, truncate);
-    Filter gaussX(fData, fData.size(), 1);
-    Image imFilter = gaussX.convolve(im, clamp);
-    return imFilter;
+    const vector<float> &fData = cachedGaussKernel(sigma, truncate);
+    return convolveSeparable(im, fData, vector<float>(1, 1.0f), clamp);
 }
 
 vector<float> gauss2DFilterValues(float sigma, float truncate){
@@ -210,12 +397,7 @@ Image gaussianBlur_2D(const Image &im, float sigma, float truncate, bool clamp){
     
     // --------- SOLUTION PS02 ------------------------------
     // blur using a 2D gaussian filter
-    vector<float> fData = gauss2DFilterValues(sigma, truncate);
-    int k = sqrt(fData.size());
-    Filter gauss(fData, k, k);
-    Image imFilter = gauss.convolve(im, clamp);
-
-    return imFilter;
+    return cachedGaussFilter(sigma, truncate, KERNEL_2D).convolve(im, clamp);
 }
 
 Image gaussianBlur_separable(const Image &im, float sigma, float truncate, bool clamp){
@@ -225,31 +407,42 @@ Image gaussianBlur_separable(const Image &im, float sigma, float truncate, bool
     
     // --------- SOLUTION PS02 ------------------------------
     // blur using 2, 1D filters in the x and y directions
-    vector<float> fData = gauss1DFilterValues(sigma, truncate);
-    Filter gaussX(fData, fData.size(), 1);
-    Filter gaussY(fData, 1, fData.size());
-    Image imFilter = gaussX.convolve(im, clamp);
-    imFilter = gaussY.convolve(imFilter, clamp);
-    
-    return imFilter;
+    const vector<float> &fData = cachedGaussKernel(sigma, truncate);
+    return convolveSeparable(im, fData, fData, clamp);
 }
 
 
-Image unsharpMask(const Image &im, float sigma, float truncate, float strength, bool clamp){
+Image unsharpMask(const Image &im, float sigma, float truncate, float strength, bool clamp, float threshold, float overshoot){
     // // --------- HANDOUT  PS02 ------------------------------
     // // sharpen an image
     // return im;
     
     // --------- SOLUTION PS02 ------------------------------
-    // get the low pass image
-    Image lowPass = gaussianBlur_separable(im, sigma, truncate, clamp);
-    // subtract it from the original image to get the high pass image
-    Image highPass = im - lowPass;
-
-    // Increase the highPass component to sharpen
-    Image sharp = im + strength*highPass;
-    return sharp;
-    
+    // The low pass is computed tile by tile and the high pass is added back
+    // as each blurred value comes out, so only the output is allocated.
+    const vector<float> &fData = cachedGaussKernel(sigma, truncate);
+    return separableTiles(im, fData, fData, clamp,
+        [&](int x, int y, int z, float lowPass) {
+            float v = im(x, y, z);
+            float highPass = v - lowPass;
+            // leave low contrast detail, such as noise, untouched
+            if (fabs(highPass) < threshold) return v;
+            float sharp = v + strength*highPass;
+            if (overshoot >= 0.0f) {
+                // keep the result within the 3x3 input range, plus the
+                // allowed overshoot, to limit halos along edges
+                float lo = v, hi = v;
+                for (int dy = -1; dy <= 1; dy++)
+                for (int dx = -1; dx <= 1; dx++)
+                {
+                    float n = im.smartAccessor(x+dx, y+dy, z, true);
+                    lo = min(lo, n);
+                    hi = max(hi, n);
+                }
+                sharp = min(max(sharp, lo - overshoot), hi + overshoot);
+            }
+            return sharp;
+        });
 }
 
 
@@ -395,46 +588,86 @@ float & Filter::operator()(int x, int y) {
 
 // --------- HANDOUT  PS07 ------------------------------
 Image gradientX(const Image &im, bool clamp){
-    Filter sobelX(3, 3);
-    sobelX(0,0) = -1.0; sobelX(1,0) = 0.0; sobelX(2,0) = 1.0;
-    sobelX(0,1) = -2.0; sobelX(1,1) = 0.0; sobelX(2,1) = 2.0;
-    sobelX(0,2) = -1.0; sobelX(1,2) = 0.0; sobelX(2,2) = 1.0;
-
-    Image imSobelX = sobelX.convolve(im, clamp);
-    return imSobelX;
+    return sobelGradients(im, GRAD_X, clamp).x;
 }
 
 
 Image gradientY(const Image &im, bool clamp) {
+    return sobelGradients(im, GRAD_Y, clamp).y;
+}
 
-    // sobel filtering in y direction
-    Filter sobelY(3, 3);
-    sobelY(0,0) = -1.0; sobelY(1,0) = -2.0; sobelY(2,0) = -1.0;
-    sobelY(0,1) = 0.0; sobelY(1,1) = 0.0; sobelY(2,1) = 0.0;
-    sobelY(0,2) = 1.0; sobelY(1,2) = 2.0; sobelY(2,2) = 1.0;
+// Running max/min along one line of n samples (van Herk / Gil-Werman).
+// out[i] is the extremum of in[i-before .. i+after], truncated to the line.
+// The line is split in blocks of the window size d; a prefix scan g and a
+// suffix scan h inside each block give any window as max(h[a], g[a+d-1]),
+// i.e. about 3 comparisons per sample whatever the window size.
+template <class Op>
+static void runningExtremum(const vector<float> &in, int before, int after, vector<float> &out, Op op, float identity) {
+    int n = in.size();
+    int d = before + after + 1;
+    int padded = ((n + d - 1 + d - 1) / d) * d;
+
+    vector<float> g(padded), h(padded);
+    for (int k = 0; k < padded; k++) {
+        int src = k - before;
+        float v = (src >= 0 && src < n) ? in[src] : identity;
+        g[k] = (k % d == 0) ? v : op(g[k-1], v);
+        h[k] = v;
+    }
+    for (int k = padded - 2; k >= 0; k--) {
+        if ((k+1) % d != 0) h[k] = op(h[k], h[k+1]);
+    }
 
+    out.resize(n);
+    for (int i = 0; i < n; i++) {
+        out[i] = op(h[i], g[i+d-1]);
+    }
+}
 
-    Image imSobelY = sobelY.convolve(im, clamp);
-    return imSobelY;
+struct MaxOp { float operator()(float a, float b) const { return a > b ? a : b; } };
+struct MinOp { float operator()(float a, float b) const { return a < b ? a : b; } };
+
+// Separable rectangular extremum filter: a pass along x then one along y
+template <class Op>
+static Image extremumFilter(const Image &im, int width, int height, Op op, float identity) {
+    Image tmp(im.width(), im.height(), im.channels());
+    Image out(im.width(), im.height(), im.channels());
+    int beforeX = width / 2,  afterX = width - beforeX - 1;
+    int beforeY = height / 2, afterY = height - beforeY - 1;
+
+    vector<float> line, result;
+    for (int c = 0; c < im.channels(); c++) {
+        line.resize(im.width());
+        for (int j = 0; j < im.height(); j++) {
+            for (int i = 0; i < im.width(); i++) line[i] = im(i, j, c);
+            runningExtremum(line, beforeX, afterX, result, op, identity);
+            for (int i = 0; i < im.width(); i++) tmp(i, j, c) = result[i];
+        }
+        line.resize(im.height());
+        for (int i = 0; i < im.width(); i++) {
+            for (int j = 0; j < im.height(); j++) line[j] = tmp(i, j, c);
+            runningExtremum(line, beforeY, afterY, result, op, identity);
+            for (int j = 0; j < im.height(); j++) out(i, j, c) = result[j];
+        }
+    }
+    return out;
 }
 
 Image maximum_filter(const Image &im, float maxiDiam) {
-    float mi = floor((maxiDiam) / 2);
-    float ma = maxiDiam - mi - 1;
+    return maximum_filter_rect(im, int(maxiDiam), int(maxiDiam));
+}
 
-    Image mf(im.width(), im.height(), im.channels());
-    for (int c = 0; c < im.channels(); c++) 
-    for (int i = mi; i < im.width() - ma; i++) 
-    for (int j = mi; j < im.height() - ma; j++) 
-    {
+Image minimum_filter(const Image &im, float miniDiam) {
+    return minimum_filter_rect(im, int(miniDiam), int(miniDiam));
+}
 
-        for (int deli = -mi; deli <= ma; deli++) 
-        for (int delj = -mi; delj <= ma; delj++) 
-        {
-            mf(i, j, c) = max(mf(i, j, c), im(i+deli, j+delj, c));
-        }
+// A window narrower than one pixel is treated as a single pixel (identity),
+// a zero block size would otherwise divide by zero in runningExtremum
+Image maximum_filter_rect(const Image &im, int width, int height) {
+    return extremumFilter(im, max(width, 1), max(height, 1), MaxOp(), -FLT_MAX);
+}
 
-    }
-    return mf;
+Image minimum_filter_rect(const Image &im, int width, int height) {
+    return extremumFilter(im, max(width, 1), max(height, 1), MinOp(), FLT_MAX);
 }
 // ------------------------------------------------------
@@ -31,7 +31,7 @@ public:
     ~Filter();
     
     // function to convolve your filter with an image
-    Image convolve(const Image &im, bool clamp=true);
+    Image convolve(const Image &im, bool clamp=true) const;
     
     // Accessors of the filter values
     const float & operator()(int x, int y) const;
@@ -47,6 +47,9 @@ private:
     
 };
 
+// Tiled separable convolution: kx along x, then ky along y
+Image convolveSeparable(const Image &im, const vector<float> &kx, const vector<float> &ky, bool clamp=true);
+
 // Box Blurring
 Image boxBlur(const Image &im, int k, bool clamp=true);
 Image boxBlur_filterClass(const Image &im, int k, bool clamp=true);
@@ -54,15 +57,43 @@ Image boxBlur_filterClass(const Image &im, int k, bool clamp=true);
 // Gradient Filter
 Image gradientMagnitude(const Image &im, bool clamp=true);
 
+// Outputs of the fused Sobel kernel, to be or'ed together
+enum GradientOutput {
+    GRAD_X           = 1,
+    GRAD_Y           = 2,
+    GRAD_MAGNITUDE   = 4,
+    GRAD_ORIENTATION = 8,
+    GRAD_TENSOR      = 16  // Ix^2, IxIy, Iy^2 summed over channels
+};
+
+// Images that were not requested are left as 1x1x1 placeholders
+struct SobelGradients {
+    SobelGradients();
+    Image x, y, magnitude, orientation, tensor;
+};
+
+// Reads each 3x3 neighborhood once and writes the requested outputs
+SobelGradients sobelGradients(const Image &im, int outputs, bool clamp=true);
+
 // Gaussian Blurring
 vector<float> gauss1DFilterValues(float sigma, float truncate);
 vector<float> gauss2DFilterValues(float sigma, float truncate);
+// Memoized gaussian kernels and filters keyed by (sigma, truncate, shape),
+// safe to call from several threads. The fixed-point taps sum to exactly
+// 1 << fracBits.
+enum KernelShape { KERNEL_1D, KERNEL_2D };
+const vector<float> & cachedGaussKernel(float sigma, float truncate=3.0, KernelShape shape=KERNEL_1D);
+const Filter & cachedGaussFilter(float sigma, float truncate=3.0, KernelShape shape=KERNEL_2D);
+const vector<int> & cachedGaussKernelFixed(float sigma, float truncate=3.0, int fracBits=14);
 Image gaussianBlur_horizontal(const Image &im, float sigma, float truncate=3.0, bool clamp=true);
 Image gaussianBlur_separable(const Image &im, float sigma, float truncate=3.0, bool clamp=true);
 Image gaussianBlur_2D(const Image &im, float sigma, float truncate=3.0, bool clamp=true);
 
-// Sharpen an Image
-Image unsharpMask(const Image &im, float sigma, float truncate=3.0, float strength=1.0, bool clamp=true);
+// Sharpen an Image in a single fused pass. Pixels whose high pass is below threshold are left
+// unchanged, and overshoot >= 0 clamps the result to the 3x3 input range
+// widened by overshoot.
+Image unsharpMask(const Image &im, float sigma, float truncate=3.0, float strength=1.0, bool clamp=true,
+                  float threshold=0.0, float overshoot=-1.0);
 
 // Bilaterial Filtering
 Image bilateral(const Image &im, float sigmaRange=0.1, float sigmaDomain=1.0, float truncateDomain=3.0, bool clamp=true);
@@ -75,6 +106,10 @@ Image impulseImg(int k);
  
 // --------- HANDOUT PS07 ------------------------------
 Image maximum_filter(const Image &im, float maxiDiam);
+// Dilation / erosion over a width x height window (truncated at the border)
+Image minimum_filter(const Image &im, float miniDiam);
+Image maximum_filter_rect(const Image &im, int width, int height);
+Image minimum_filter_rect(const Image &im, int width, int height);
 Image gradientX(const Image &im, bool clamp=true);
 Image gradientY(const Image &im, bool clamp=true);
 // ------------------------------------------------------
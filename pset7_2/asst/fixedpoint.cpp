@@ -0,0 +1,286 @@
+/* --------------------------------------------------------------------------
+ * File:    fixedpoint.cpp
+ * Created: 2026-10-18
+ * --------------------------------------------------------------------------
+ *
+ * 8/16-bit integer images and fixed-point filtering
+ *
+ * ------------------------------------------------------------------------*/
+
+
+#include "fixedpoint.h"
+#include "filtering.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+// fractional bits of the kernels and color matrices
+static const int FIXED_FRAC_BITS = 14;
+
+// Precision kept between the two passes of a separable filter: 8-bit data
+// keeps 7 extra bits (15 bits in an int32), 16-bit data none so that the
+// second pass still fits 16 + 14 bits in an int32.
+template <typename T> struct FixedTraits;
+template <> struct FixedTraits<uint8_t>  { static const int extraBits = 7; };
+template <> struct FixedTraits<uint16_t> { static const int extraBits = 0; };
+
+template <> const int ImageInt<uint8_t>::maxValue  = 255;
+template <> const int ImageInt<uint16_t>::maxValue = 65535;
+
+static inline int clampIndex(int i, int n) {
+    return i < 0 ? 0 : (i >= n ? n-1 : i);
+}
+
+template <typename T>
+static inline T saturate(int v) {
+    return T(v < 0 ? 0 : (v > ImageInt<T>::maxValue ? ImageInt<T>::maxValue : v));
+}
+
+// fixed-point representation of a float coefficient
+static inline int toFixedCoef(float f) {
+    return int(floor(f * (1 << FIXED_FRAC_BITS) + 0.5f));
+}
+
+
+template <typename T>
+ImageInt<T>::ImageInt(int width_, int height_, int channels_)
+    : w(width_), h(height_), c(channels_), image_data((long long)width_*height_*channels_, 0)
+{
+    if (w < 1 || h < 1 || c < 1)
+        throw NegativeDimensionException();
+}
+
+template <typename T>
+const T & ImageInt<T>::operator()(int x, int y, int z) const {
+    if (x < 0 || x >= w || y < 0 || y >= h || z < 0 || z >= c)
+        throw OutOfBoundsException();
+    return image_data[x + y*w + z*w*h];
+}
+
+template <typename T>
+T & ImageInt<T>::operator()(int x, int y, int z) {
+    if (x < 0 || x >= w || y < 0 || y >= h || z < 0 || z >= c)
+        throw OutOfBoundsException();
+    return image_data[x + y*w + z*w*h];
+}
+
+
+template <typename T>
+ImageInt<T> toFixed(const Image &im) {
+    ImageInt<T> out(im.width(), im.height(), im.channels());
+    T *dst = out.data();
+    for (long long i = 0; i < im.number_of_elements(); i++) {
+        float v = min(max(im(i), 0.0f), 1.0f);
+        dst[i] = T(v * ImageInt<T>::maxValue + 0.5f);
+    }
+    return out;
+}
+
+template <typename T>
+Image toFloat(const ImageInt<T> &im) {
+    Image out(im.width(), im.height(), im.channels());
+    const T *src = im.data();
+    float scale = 1.0f / ImageInt<T>::maxValue;
+    for (long long i = 0; i < im.number_of_elements(); i++) {
+        out(i) = src[i] * scale;
+    }
+    return out;
+}
+
+
+// Separable convolution with the same integer kernel along x and y. Tap i
+// reads the sample at offset i - center. The first pass rounds to
+// FRAC - extraBits fractional bits into an int32 buffer, the second pass
+// rounds back to T and saturates.
+template <typename T>
+static ImageInt<T> convolveFixed(const ImageInt<T> &im, const vector<int> &kernel, int center) {
+    const int E = FixedTraits<T>::extraBits;
+    const int shift1 = FIXED_FRAC_BITS - E;
+    const int shift2 = FIXED_FRAC_BITS + E;
+    int w = im.width(), h = im.height();
+    int n = kernel.size();
+    const int *k = &kernel[0];
+
+    ImageInt<T> out(w, h, im.channels());
+    vector<int32_t> inter(w*h);
+
+    for (int z = 0; z < im.channels(); z++) {
+        const T *src = im.data() + (long long)z*w*h;
+        T *dst = out.data() + (long long)z*w*h;
+
+        #pragma omp parallel for
+        for (int y = 0; y < h; y++) {
+            const T *row = src + y*w;
+            int32_t *irow = &inter[y*w];
+            for (int x = 0; x < w; x++) {
+                int32_t acc = 0;
+                if (x - center >= 0 && x - center + n <= w) {
+                    const T *p = row + x - center;
+                    for (int i = 0; i < n; i++) acc += k[i] * p[i];
+                } else {
+                    for (int i = 0; i < n; i++) acc += k[i] * row[clampIndex(x+i-center, w)];
+                }
+                irow[x] = (acc + (1 << (shift1-1))) >> shift1;
+            }
+        }
+
+        #pragma omp parallel for
+        for (int y = 0; y < h; y++) {
+            vector<const int32_t*> r(n);
+            for (int i = 0; i < n; i++) r[i] = &inter[clampIndex(y+i-center, h)*w];
+
+            T *drow = dst + y*w;
+            for (int x = 0; x < w; x++) {
+                int32_t acc = 0;
+                for (int i = 0; i < n; i++) acc += k[i] * r[i][x];
+                drow[x] = saturate<T>((acc + (1 << (shift2-1))) >> shift2);
+            }
+        }
+    }
+    return out;
+}
+
+template <typename T>
+ImageInt<T> gaussianBlurInt(const ImageInt<T> &im, float sigma, float truncate) {
+    const vector<int> &kernel = cachedGaussKernelFixed(sigma, truncate, FIXED_FRAC_BITS);
+    return convolveFixed(im, kernel, kernel.size()/2);
+}
+
+template <typename T>
+ImageInt<T> boxBlurInt(const ImageInt<T> &im, int k) {
+    // same footprint as boxBlur, the rounding residual goes to the center tap
+    int sideSize = int((k-1.0f)/2.0f);
+    vector<int> kernel(k, (1 << FIXED_FRAC_BITS) / k);
+    kernel[k-1-sideSize] += (1 << FIXED_FRAC_BITS) - kernel[0]*k;
+    return convolveFixed(im, kernel, k-1-sideSize);
+}
+
+
+template <typename T>
+ImageInt<T> gradientMagnitudeInt(const ImageInt<T> &im) {
+    int w = im.width(), h = im.height();
+    ImageInt<T> out(w, h, im.channels());
+
+    for (int z = 0; z < im.channels(); z++) {
+        const T *src = im.data() + (long long)z*w*h;
+        T *dst = out.data() + (long long)z*w*h;
+
+        #pragma omp parallel for
+        for (int y = 0; y < h; y++) {
+            const T *r0 = src + clampIndex(y-1, h)*w;
+            const T *r1 = src + y*w;
+            const T *r2 = src + clampIndex(y+1, h)*w;
+            for (int x = 0; x < w; x++) {
+                int xm = clampIndex(x-1, w), xp = clampIndex(x+1, w);
+                int64_t gx = (r0[xm] + 2*r1[xm] + r2[xm]) - (r0[xp] + 2*r1[xp] + r2[xp]);
+                int64_t gy = (r0[xm] + 2*r0[x] + r0[xp]) - (r2[xm] + 2*r2[x] + r2[xp]);
+                double mag = sqrt(double(gx*gx + gy*gy));
+                dst[y*w + x] = saturate<T>(int(mag/4 + 0.5));
+            }
+        }
+    }
+    return out;
+}
+
+
+template <typename T>
+ImageInt<T> unsharpMaskInt(const ImageInt<T> &im, float sigma, float truncate, float strength) {
+    // strength with 8 fractional bits
+    const int STRENGTH_BITS = 8;
+    int s = int(floor(strength * (1 << STRENGTH_BITS) + 0.5f));
+    ImageInt<T> lowPass = gaussianBlurInt(im, sigma, truncate);
+    ImageInt<T> out(im.width(), im.height(), im.channels());
+
+    const T *src = im.data();
+    const T *low = lowPass.data();
+    T *dst = out.data();
+    long long n = im.number_of_elements();
+
+    #pragma omp parallel for
+    for (long long i = 0; i < n; i++) {
+        int64_t detail = int64_t(s) * (int(src[i]) - int(low[i]));
+        int64_t rounded = (detail + (1 << (STRENGTH_BITS-1))) >> STRENGTH_BITS;
+        dst[i] = saturate<T>(int(src[i] + rounded));
+    }
+    return out;
+}
+
+
+// 3x3 matrix in fixed point plus an offset in units of maxValue, applied to
+// the pixels of a 3-channel image
+template <typename T>
+static ImageInt<T> colorMatrixInt(const ImageInt<T> &im, const float m[3][3], const float offset[3]) {
+    if (im.channels() != 3)
+        throw ChannelException();
+    int mf[3][3];
+    int64_t of[3];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) mf[i][j] = toFixedCoef(m[i][j]);
+        of[i] = int64_t(floor(offset[i] * ImageInt<T>::maxValue * (1 << FIXED_FRAC_BITS) + 0.5));
+    }
+
+    int w = im.width(), h = im.height();
+    long long plane = (long long)w*h;
+    ImageInt<T> out(w, h, 3);
+    const T *src = im.data();
+    T *dst = out.data();
+    const int64_t round = 1 << (FIXED_FRAC_BITS-1);
+
+    #pragma omp parallel for
+    for (long long i = 0; i < plane; i++) {
+        int64_t a = src[i], b = src[i+plane], c = src[i+2*plane];
+        for (int k = 0; k < 3; k++) {
+            int64_t acc = mf[k][0]*a + mf[k][1]*b + mf[k][2]*c + of[k] + round;
+            dst[i + k*plane] = saturate<T>(int(acc >> FIXED_FRAC_BITS));
+        }
+    }
+    return out;
+}
+
+// half-range of U and V in the float rgb2yuv
+static const float U_MAX = 0.436f;
+static const float V_MAX = 0.615f;
+
+template <typename T>
+ImageInt<T> rgb2yuvInt(const ImageInt<T> &im) {
+    // the chroma rows are scaled to [-0.5, 0.5] and offset by 0.5
+    float su = 0.5f / U_MAX, sv = 0.5f / V_MAX;
+    const float m[3][3] = {
+        {0.299f,        0.587f,       0.114f},
+        {-0.147f*su,   -0.289f*su,    0.436f*su},
+        {0.615f*sv,    -0.515f*sv,   -0.100f*sv}};
+    const float offset[3] = {0.0f, 0.5f, 0.5f};
+    return colorMatrixInt(im, m, offset);
+}
+
+template <typename T>
+ImageInt<T> yuv2rgbInt(const ImageInt<T> &im) {
+    // undo the chroma scaling, the -0.5 offset is folded in the constant
+    float su = 2.0f * U_MAX, sv = 2.0f * V_MAX;
+    const float m[3][3] = {
+        {1.0f,  0.0f,          1.14f*sv},
+        {1.0f, -0.395f*su,    -0.581f*sv},
+        {1.0f,  2.032f*su,     0.0f}};
+    const float offset[3] = {
+        -0.5f*m[0][2],
+        -0.5f*(m[1][1] + m[1][2]),
+        -0.5f*m[2][1]};
+    return colorMatrixInt(im, m, offset);
+}
+
+
+// 8 and 16-bit instantiations
+#define INSTANTIATE_FIXED(T) \
+    template class ImageInt<T>; \
+    template ImageInt<T> toFixed<T>(const Image &im); \
+    template Image toFloat<T>(const ImageInt<T> &im); \
+    template ImageInt<T> gaussianBlurInt<T>(const ImageInt<T> &im, float sigma, float truncate); \
+    template ImageInt<T> boxBlurInt<T>(const ImageInt<T> &im, int k); \
+    template ImageInt<T> gradientMagnitudeInt<T>(const ImageInt<T> &im); \
+    template ImageInt<T> unsharpMaskInt<T>(const ImageInt<T> &im, float sigma, float truncate, float strength); \
+    template ImageInt<T> rgb2yuvInt<T>(const ImageInt<T> &im); \
+    template ImageInt<T> yuv2rgbInt<T>(const ImageInt<T> &im);
+
+INSTANTIATE_FIXED(uint8_t)
+INSTANTIATE_FIXED(uint16_t)
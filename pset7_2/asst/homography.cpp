@@ -4,45 +4,23 @@
 using namespace std;
 
 
+ProjectiveCoords homographyCoords(const Matrix &H) {
+    // output to source mapping, row major
+    Matrix inv_H = H.inverse();
+    float h[9];
+    for (int i = 0; i < 3; i++)
+    for (int j = 0; j < 3; j++)
+        h[3*i+j] = inv_H(i,j);
+    return ProjectiveCoords(h);
+}
+
+
 void applyHomography(const Image &source, const Matrix &H, Image &out, bool bilinear) {
     // // --------- HANDOUT  PS06 ------------------------------
     // Transform image source using the homography H, and composite in onto out.
     // if bilinear == true, using bilinear interpolation. Use nearest neighbor
     // otherwise.
-
-    Matrix inv_H = H.inverse();
-
-    for (int a = 0; a < out.width(); a++){
-        for (int b = 0; b < out.height(); b++){
-            for (int c = 0; c < out.channels(); c++){
-                
-                Matrix homographic_points = Matrix(3,1);
-                homographic_points(0,0) = a;
-                homographic_points(1,0) = b;
-                homographic_points(2,0) = 1;
-
-                Matrix soln = inv_H * homographic_points;
-
-                float new_x = soln(0,0)/soln(2,0);
-                float new_y = soln(1,0)/soln(2,0);
-
-                if (new_x >= 0 && new_y >= 0 && new_x < source.width() - 1&& new_y < source.height() - 1){
-                    float pixel_value;
-                    if (bilinear){
-                        pixel_value = interpolateLin(source, new_x, new_y, c, false);
-                        //interpolateLin(const Image &im, float x, float y, int z, bool clamp)
-                    }
-                    else {
-                        pixel_value = source(round(new_x), round(new_y), c);
-                    }
-
-                    out(a, b, c) = pixel_value;
-
-                }
-
-            }
-        }
-    }
+    remap(source, homographyCoords(H), out, bilinear, REMAP_SKIP);
 }
 
 
@@ -243,40 +221,5 @@ void applyHomographyFast(const Image &source, const Matrix &H, Image &out, bool
     // Same as apply but change only the pixels of out that are within the
     // predicted bounding box (when H maps source to its new position).
     BoundingBox B = computeTransformedBBox(source.width(), source.height(), H);
-
-    std::cout << "In applyHomographyFast " << endl;
-
-    Matrix inv_H = H.inverse();
-    for (int a = B.x1; a < B.x2 + 1; a++){
-        for (int b = B.y1; b < B.y2 + 1; b++){
-            for (int c = 0; c < out.channels(); c++){
-                
-                Matrix homographic_points = Matrix(3,1);
-                homographic_points(0,0) = a;
-                homographic_points(1,0) = b;
-                homographic_points(2,0) = 1;
-
-                Matrix soln = inv_H * homographic_points;
-
-                float new_x = soln(0,0)/soln(2,0);
-                float new_y = soln(1,0)/soln(2,0);
-
-                if (new_x >= 0 && new_y >= 0 && new_x < source.width() - 1 && new_y < source.height() - 1){
-                    float pixel_value;
-                    if (bilinear){
-                        pixel_value = interpolateLin(source, new_x, new_y, c, false);
-                        //interpolateLin(const Image &im, float x, float y, int z, bool clamp)
-                    }
-                    else {
-                        pixel_value = source(round(new_x), round(new_y), c);
-                    }
-
-                    out(a, b, c) = pixel_value;
-
-                }
-
-            }
-        }
-    }
-
+    remap(source, homographyCoords(H), out, bilinear, REMAP_SKIP, NULL, B.x1, B.y1, B.x2+1, B.y2+1);
 }
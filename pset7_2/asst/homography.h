@@ -14,6 +14,7 @@
 #include "Image.h"
 #include "basicImageManipulation.h"
 #include "matrix.h"
+#include "remap.h"
 #include <iostream>
 #include <cmath>
 
@@ -64,6 +65,9 @@ public:
 
 
 // Apply homographies
+// Source coordinates of the output pixels for a homography H mapping the
+// source into the output
+ProjectiveCoords homographyCoords(const Matrix &H);
 void applyHomography(const Image &source, const Matrix &H, Image &out, bool bilinear=false);
 void applyHomographyFast(const Image &source, const Matrix &H, Image &out, bool bilinear=false);
 
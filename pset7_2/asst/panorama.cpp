@@ -15,22 +15,12 @@ Image computeTensor(const Image &im, float sigmaG, float factorSigma) {
     //to control the scale at which corners are extracted. A little bit
     //of blur helps smooth things out and help extract stable mid-scale corners.
     Image blurred_lumi = gaussianBlur_separable(lumi, sigmaG);
-    Image gradientX_lumi = gradientX(blurred_lumi);
-    Image gradientY_lumi = gradientY(blurred_lumi);
 
-    //Structure tensor image
+    //Structure tensor image, computed in the same pass as the gradients
     //Where channel 0 is Ix2
     //and channel 1 is IxIy
     //Channel 2 is Iy2
-    Image perPixelContributions(im.width(), im.height(), 3);
-
-    for (int i = 0; i < im.width(); i++){
-        for (int j = 0; j < im.height(); j++){
-            perPixelContributions(i,j,0) = pow(gradientX_lumi(i,j),2);
-            perPixelContributions(i,j,1) = gradientX_lumi(i,j)*gradientY_lumi(i,j);
-            perPixelContributions(i,j,2) = pow(gradientY_lumi(i,j),2);
-        }
-    }
+    Image perPixelContributions = sobelGradients(blurred_lumi, GRAD_TENSOR).tensor;
 
     Image structure_tensor = gaussianBlur_separable(perPixelContributions, sigmaG*factorSigma);
 
@@ -290,7 +280,8 @@ Image autostitch(Image &im1, Image &im2, float blurDescriptor, float radiusDescr
 // ****************************************************************************
 
 Image getBlurredLumi(const Image &im, float sigmaG) {
-    return Image(1,1,1);
+    // luminance blurred with the (cached) gaussian kernel of std sigmaG
+    return gaussianBlur_separable(color2gray(im), sigmaG);
 }
 
 int countBoolVec(vector<bool> ins) {
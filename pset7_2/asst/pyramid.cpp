@@ -0,0 +1,103 @@
+/* --------------------------------------------------------------------------
+ * File:    pyramid.cpp
+ * Created: 2026-10-18
+ * --------------------------------------------------------------------------
+ *
+ * Gaussian and Laplacian pyramids
+ *
+ * ------------------------------------------------------------------------*/
+
+
+#include "pyramid.h"
+#include "resample.h"
+#include <algorithm>
+
+using namespace std;
+
+static const float binomial[5] = {1.0f/16, 4.0f/16, 6.0f/16, 4.0f/16, 1.0f/16};
+
+static inline int clampIndex(int i, int n) {
+    return i < 0 ? 0 : (i >= n ? n-1 : i);
+}
+
+Image pyrDown(const Image &im) {
+    // blur and decimate, the binomial taps centered on every other sample
+    // go through the separable resampler
+    auto table = [](int n) {
+        ResampleTable t;
+        t.inSize = n;
+        t.outSize = (n+1)/2;
+        t.taps = 5;
+        for (int i = 0; i < t.outSize; i++)
+        for (int k = 0; k < 5; k++)
+        {
+            t.index.push_back(clampIndex(2*i+k-2, n));
+            t.weight.push_back(binomial[k]);
+        }
+        return t;
+    };
+    return resampleSeparable(im, table(im.width()), table(im.height()));
+}
+
+Image pyrUp(const Image &im, int width, int height) {
+    // Zero insertion followed by the binomial blur scaled by 2, written out
+    // as the even (1 6 1)/8 and odd (4 4)/8 phases
+    auto table = [](int n, int outSize) {
+        ResampleTable t;
+        t.inSize = n;
+        t.outSize = outSize;
+        t.taps = 3;
+        for (int x = 0; x < outSize; x++) {
+            int i = x/2;
+            bool odd = x%2 == 1;
+            t.index.push_back(clampIndex(odd ? i : i-1, n));
+            t.index.push_back(clampIndex(odd ? i+1 : i, n));
+            t.index.push_back(clampIndex(i+1, n));
+            t.weight.push_back(odd ? 0.5f : 1.0f/8);
+            t.weight.push_back(odd ? 0.5f : 6.0f/8);
+            t.weight.push_back(odd ? 0.0f : 1.0f/8);
+        }
+        return t;
+    };
+    return resampleSeparable(im, table(im.width(), width), table(im.height(), height));
+}
+
+
+Pyramid::Pyramid(const Image &im, Type type, int levels, int minSize) : pyrType(type) {
+    // gaussian levels
+    pyr.push_back(im);
+    while ((levels <= 0 || (int)pyr.size() < levels)
+            && min(pyr.back().width(), pyr.back().height()) >= 2*minSize) {
+        pyr.push_back(pyrDown(pyr.back()));
+    }
+
+    // replace them by the band-pass differences, the coarsest level is kept
+    if (type == LAPLACIAN) {
+        for (int i = 0; i < (int)pyr.size()-1; i++) {
+            pyr[i] = pyr[i] - pyrUp(pyr[i+1], pyr[i].width(), pyr[i].height());
+        }
+    }
+}
+
+const Image & Pyramid::level(int i) const {
+    if (i < 0 || i >= levels())
+        throw OutOfBoundsException();
+    return pyr[i];
+}
+
+Image & Pyramid::operator[](int i) {
+    if (i < 0 || i >= levels())
+        throw OutOfBoundsException();
+    return pyr[i];
+}
+
+Image Pyramid::collapse() const {
+    if (pyrType == GAUSSIAN) {
+        return pyr[0];
+    }
+    Image out = pyr.back();
+    for (int i = levels()-2; i >= 0; i--) {
+        out = pyr[i] + pyrUp(out, pyr[i].width(), pyr[i].height());
+    }
+    return out;
+}
@@ -0,0 +1,54 @@
+/* --------------------------------------------------------------------------
+ * File:    pyramid.h
+ * Created: 2026-10-18
+ * --------------------------------------------------------------------------
+ *
+ * Gaussian and Laplacian pyramids
+ *
+ * ------------------------------------------------------------------------*/
+
+
+#ifndef __pyramid__h
+#define __pyramid__h
+
+#include "Image.h"
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+// Blur with the 5-tap binomial [1 4 6 4 1]/16 and keep every other sample.
+// The output is ceil(w/2) x ceil(h/2).
+Image pyrDown(const Image &im);
+// Upsample to width x height, interpolating with the same binomial kernel
+Image pyrUp(const Image &im, int width, int height);
+
+
+// Consumers that need the pyramid of the same image several times keep
+// the Pyramid they built and pass it along, as with MipMap.
+class Pyramid {
+public:
+    enum Type { GAUSSIAN, LAPLACIAN };
+
+    // Build a pyramid with the given number of levels (level 0 is the full
+    // resolution). levels=0 keeps reducing until a side gets below minSize.
+    Pyramid(const Image &im, Type type=GAUSSIAN, int levels=0, int minSize=8);
+
+    int levels() const { return int(pyr.size()); }
+    Type type() const { return pyrType; }
+
+    // Accessors of the pyramid levels
+    const Image & level(int i) const;
+    const Image & operator[](int i) const { return level(i); }
+    Image & operator[](int i);
+
+    // Reconstruct the full resolution image. For a Laplacian pyramid the
+    // bands are expanded and summed from the coarsest level.
+    Image collapse() const;
+
+private:
+    vector<Image> pyr;
+    Type pyrType;
+};
+
+#endif
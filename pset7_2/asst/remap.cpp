@@ -0,0 +1,270 @@
+/* --------------------------------------------------------------------------
+ * File:    remap.cpp
+ * Created: 2026-10-18
+ * --------------------------------------------------------------------------
+ *
+ * Generic remap: for every output pixel, sample the source at a
+ * generated coordinate
+ *
+ * ------------------------------------------------------------------------*/
+
+
+#include "remap.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+// Output tiles, small enough that the source footprint of a rotated or
+// projected tile stays in cache
+static const int REMAP_TILE_W = 64;
+static const int REMAP_TILE_H = 64;
+
+
+AffineCoords::AffineCoords(const float m_[6]) {
+    for (int i = 0; i < 6; i++) m[i] = m_[i];
+}
+
+void AffineCoords::row(int x0, int y, int n, float *xs, float *ys) const {
+    // constant part of the row, then one multiply-add per pixel: adding
+    // m[0] n times instead would drift by a few thousandths of a pixel
+    // across a tile on large images
+    float bx = m[1]*y + m[2], by = m[4]*y + m[5];
+    for (int i = 0; i < n; i++) {
+        xs[i] = m[0]*(x0+i) + bx;
+        ys[i] = m[3]*(x0+i) + by;
+    }
+}
+
+// Narrow [lo, hi] to the i for which v0 + i*dv >= 0
+static void clipHalfLine(float v0, float dv, float &lo, float &hi) {
+    if (dv == 0.0f) {
+        if (v0 < 0.0f) { lo = 1.0f; hi = 0.0f; }
+    } else if (dv > 0.0f) {
+        lo = max(lo, -v0 / dv);
+    } else {
+        hi = min(hi, -v0 / dv);
+    }
+}
+
+// Span of a row segment of n pixels whose homogeneous source is
+// (X + i*dX, Y + i*dY, W + i*dW): the box constraints times W are linear
+// in i as long as W keeps its sign. The interval is widened by a pixel on
+// each side, remap settles its ends on the generated coordinates.
+static bool projectiveSpan(float X, float dX, float Y, float dY, float W, float dW, int n,
+                           float xmin, float ymin, float xmax, float ymax, int &lo, int &hi) {
+    float wEnd = W + (n-1)*dW;
+    if (!(W > 0 && wEnd > 0) && !(W < 0 && wEnd < 0)) return false;
+    float sign = W > 0 ? 1.0f : -1.0f;
+    float a = 0.0f, b = n - 1.0f;
+    clipHalfLine(sign*(X - xmin*W), sign*(dX - xmin*dW), a, b);
+    clipHalfLine(sign*(xmax*W - X), sign*(xmax*dW - dX), a, b);
+    clipHalfLine(sign*(Y - ymin*W), sign*(dY - ymin*dW), a, b);
+    clipHalfLine(sign*(ymax*W - Y), sign*(ymax*dW - dY), a, b);
+    if (a > b) {
+        lo = hi = 0;
+    } else {
+        lo = max(0, int(floor(a)) - 1);
+        hi = min(n, int(ceil(b)) + 2);
+    }
+    return true;
+}
+
+bool AffineCoords::span(int x0, int y, int n, float xmin, float ymin, float xmax, float ymax, int &lo, int &hi) const {
+    return projectiveSpan(m[0]*x0 + m[1]*y + m[2], m[0], m[3]*x0 + m[4]*y + m[5], m[3], 1.0f, 0.0f,
+                          n, xmin, ymin, xmax, ymax, lo, hi);
+}
+
+ProjectiveCoords::ProjectiveCoords(const float h_[9]) {
+    for (int i = 0; i < 9; i++) h[i] = h_[i];
+}
+
+void ProjectiveCoords::row(int x0, int y, int n, float *xs, float *ys) const {
+    float bx = h[1]*y + h[2], by = h[4]*y + h[5], bw = h[7]*y + h[8];
+    for (int i = 0; i < n; i++) {
+        float x = float(x0+i);
+        float w = h[6]*x + bw;
+        xs[i] = (h[0]*x + bx) / w;
+        ys[i] = (h[3]*x + by) / w;
+    }
+}
+
+bool ProjectiveCoords::span(int x0, int y, int n, float xmin, float ymin, float xmax, float ymax, int &lo, int &hi) const {
+    return projectiveSpan(h[0]*x0 + h[1]*y + h[2], h[0], h[3]*x0 + h[4]*y + h[5], h[3],
+                          h[6]*x0 + h[7]*y + h[8], h[6], n, xmin, ymin, xmax, ymax, lo, hi);
+}
+
+PolarCoords::PolarCoords(float cx_, float cy_, float angleScale_, float angleOffset_, float radiusScale_, float radiusOffset_)
+    : cx(cx_), cy(cy_), angleScale(angleScale_), angleOffset(angleOffset_),
+      radiusScale(radiusScale_), radiusOffset(radiusOffset_) {}
+
+void PolarCoords::row(int x0, int y, int n, float *xs, float *ys) const {
+    float dy = y - cy;
+    for (int i = 0; i < n; i++) {
+        float dx = x0 + i - cx;
+        float angle = atan2(dy, dx);
+        if (angle < 0) angle += 2*M_PI;
+        xs[i] = angleOffset + angleScale*angle;
+        ys[i] = radiusOffset + radiusScale*sqrt(dx*dx + dy*dy);
+    }
+}
+
+FieldCoords::FieldCoords(const Image &mapX_, const Image &mapY_) : mapX(mapX_), mapY(mapY_) {
+    if (mapX.width() != mapY.width() || mapX.height() != mapY.height())
+        throw MismatchedDimensionsException();
+}
+
+void FieldCoords::row(int x0, int y, int n, float *xs, float *ys) const {
+    for (int i = 0; i < n; i++) {
+        xs[i] = mapX(x0+i, y);
+        ys[i] = mapY(x0+i, y);
+    }
+}
+
+
+// Strided view of the source, read in place
+struct RemapSource {
+    const Image &image;
+    const float *data;
+    int w, h, sx, sy, sz;
+    RemapSource(const Image &im)
+        : image(im), data(im.width() > 0 && im.height() > 0 ? &im(0, 0, 0) : NULL),
+          w(im.width()), h(im.height()), sx(im.stride(0)), sy(im.stride(1)), sz(im.stride(2)) {}
+};
+
+// Sample at (sx, sy) written or added to out(x, y). With inside set, the
+// whole footprint of the sample is in the source and is read without tests.
+static inline void gatherPixel(const RemapSource &src, float sx, float sy, bool inside, Image &out, int x, int y,
+                               int nc, bool bilinear, bool clamp, const Image *weight) {
+    float wgt = 1.0f;
+    if (weight) wgt = weight->smartAccessor(int(sx), int(sy), 0, false);
+
+    if (bilinear) {
+        // neighbors and weights are shared by all the channels
+        int xf = floor(sx), yf = floor(sy);
+        float xalpha = sx - xf, yalpha = sy - yf;
+        const float *p = inside ? src.data + xf*src.sx + yf*src.sy : NULL;
+        for (int z = 0; z < nc; z++) {
+            float tl, tr, bl, br;
+            if (inside) {
+                tl = p[0];      tr = p[src.sx];
+                bl = p[src.sy]; br = p[src.sx + src.sy];
+                p += src.sz;
+            } else {
+                tl = src.image.smartAccessor(xf,   yf,   z, clamp);
+                tr = src.image.smartAccessor(xf+1, yf,   z, clamp);
+                bl = src.image.smartAccessor(xf,   yf+1, z, clamp);
+                br = src.image.smartAccessor(xf+1, yf+1, z, clamp);
+            }
+            float topL = tr*xalpha + tl*(1.0f - xalpha);
+            float botL = br*xalpha + bl*(1.0f - xalpha);
+            float v = botL*yalpha + topL*(1.0f - yalpha);
+            if (weight) out(x, y, z) += wgt*v;
+            else        out(x, y, z) = v;
+        }
+    } else {
+        int xn = int(round(sx)), yn = int(round(sy));
+        for (int z = 0; z < nc; z++) {
+            float v = inside ? src.data[xn*src.sx + yn*src.sy + z*src.sz]
+                             : src.image.smartAccessor(xn, yn, z, clamp);
+            if (weight) out(x, y, z) += wgt*v;
+            else        out(x, y, z) = v;
+        }
+    }
+}
+
+// Output pixel outside the clipped span of its row: all the tests, then
+// the border policy
+static inline void borderPixel(const RemapSource &src, float sx, float sy, Image &out, int x, int y,
+                               int nc, bool bilinear, RemapBorder border, const Image *weight) {
+    int w = src.w, h = src.h;
+    // NaN coordinates (points at infinity) never sample
+    if (!(sx == sx && sy == sy)) return;
+    if (border == REMAP_SKIP && !(sx >= 0 && sy >= 0 && sx < w-1 && sy < h-1)) return;
+    // far outside, a black border gives black without sampling
+    if (border == REMAP_BLACK && !(sx > -1 && sy > -1 && sx < w && sy < h)) {
+        if (!weight)
+            for (int z = 0; z < nc; z++) out(x, y, z) = 0.0f;
+        return;
+    }
+
+    bool inside;
+    if (bilinear) {
+        int xf = floor(sx), yf = floor(sy);
+        inside = xf >= 0 && yf >= 0 && xf+1 < w && yf+1 < h;
+    } else {
+        int xn = int(round(sx)), yn = int(round(sy));
+        inside = xn >= 0 && yn >= 0 && xn < w && yn < h;
+    }
+    gatherPixel(src, sx, sy, inside, out, x, y, nc, bilinear, border == REMAP_CLAMP, weight);
+}
+
+void remap(const Image &source, const RemapCoords &coords, Image &out,
+           bool bilinear, RemapBorder border, const Image *weight,
+           int x0, int y0, int x1, int y1)
+{
+    if (x1 < 0) x1 = out.width();
+    if (y1 < 0) y1 = out.height();
+    x0 = max(x0, 0); y0 = max(y0, 0);
+    x1 = min(x1, out.width()); y1 = min(y1, out.height());
+    if (x0 >= x1 || y0 >= y1) return;
+
+    int w = source.width(), h = source.height();
+    int nc = out.channels();
+    if (source.channels() < nc)
+        throw ChannelException();
+
+    // Source box where a sample needs no test: the whole 2x2 neighborhood,
+    // or the rounded position, is in the image and passes the SKIP test
+    float bxmin = 0.0f, bymin = 0.0f, bxmax = w - 1.0f, bymax = h - 1.0f;
+    if (!bilinear && border != REMAP_SKIP) {
+        bxmin = -0.5f; bymin = -0.5f; bxmax = w - 0.5f; bymax = h - 0.5f;
+    }
+    // exact test on a generated coordinate, the box is half-open
+    auto unchecked = [&](float sx, float sy) {
+        if (bilinear || border == REMAP_SKIP) {
+            if (!(sx >= 0 && sy >= 0 && sx < w-1 && sy < h-1)) return false;
+        }
+        if (!bilinear) {
+            if (!(sx > -0.5f && sy > -0.5f && sx < w-0.5f && sy < h-0.5f)) return false;
+        }
+        return true;
+    };
+
+    RemapSource src(source);
+
+    int nTilesX = (x1 - x0 + REMAP_TILE_W - 1) / REMAP_TILE_W;
+    int nTilesY = (y1 - y0 + REMAP_TILE_H - 1) / REMAP_TILE_H;
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int t = 0; t < nTilesX*nTilesY; t++) {
+        int tx0 = x0 + (t % nTilesX)*REMAP_TILE_W;
+        int ty0 = y0 + (t / nTilesX)*REMAP_TILE_H;
+        int tw = min(REMAP_TILE_W, x1 - tx0);
+        int th = min(REMAP_TILE_H, y1 - ty0);
+        vector<float> xs(tw), ys(tw);
+
+        for (int y = ty0; y < ty0 + th; y++) {
+            coords.row(tx0, y, tw, &xs[0], &ys[0]);
+
+            // valid span [lo, hi) of the row, its ends settled on the
+            // generated coordinates since the bound is solved in floats
+            int lo = 0, hi = 0;
+            if (src.data && coords.span(tx0, y, tw, bxmin, bymin, bxmax, bymax, lo, hi)) {
+                while (lo < hi && !unchecked(xs[lo], ys[lo])) lo++;
+                while (hi > lo && !unchecked(xs[hi-1], ys[hi-1])) hi--;
+                if (lo < hi) {
+                    while (lo > 0 && unchecked(xs[lo-1], ys[lo-1])) lo--;
+                    while (hi < tw && unchecked(xs[hi], ys[hi])) hi++;
+                }
+            }
+
+            for (int i = 0; i < lo; i++)
+                borderPixel(src, xs[i], ys[i], out, tx0 + i, y, nc, bilinear, border, weight);
+            for (int i = lo; i < hi; i++)
+                gatherPixel(src, xs[i], ys[i], true, out, tx0 + i, y, nc, bilinear, false, weight);
+            for (int i = hi; i < tw; i++)
+                borderPixel(src, xs[i], ys[i], out, tx0 + i, y, nc, bilinear, border, weight);
+        }
+    }
+}
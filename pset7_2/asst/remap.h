@@ -0,0 +1,93 @@
+/* --------------------------------------------------------------------------
+ * File:    remap.h
+ * Created: 2026-10-18
+ * --------------------------------------------------------------------------
+ *
+ * Generic remap: for every output pixel, sample the source at a
+ * generated coordinate
+ *
+ * ------------------------------------------------------------------------*/
+
+
+#ifndef __remap__h
+#define __remap__h
+
+#include "Image.h"
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+// Source coordinates of the output pixels, generated one row segment at a
+// time so that generators can step incrementally along the scanline
+class RemapCoords {
+public:
+    virtual ~RemapCoords() {}
+    // fill xs[i], ys[i] with the source position of output pixel (x0+i, y)
+    virtual void row(int x0, int y, int n, float *xs, float *ys) const = 0;
+    // Set [lo, hi) to the i of the same row segment whose source lies in
+    // [xmin, xmax] x [ymin, ymax], up to rounding. Returns false when the
+    // generator cannot bound its rows, remap then tests every pixel.
+    virtual bool span(int x0, int y, int n, float xmin, float ymin, float xmax, float ymax,
+                      int &lo, int &hi) const { return false; }
+};
+
+// xs = m[0]*x + m[1]*y + m[2], ys = m[3]*x + m[4]*y + m[5]
+class AffineCoords : public RemapCoords {
+public:
+    AffineCoords(const float m[6]);
+    void row(int x0, int y, int n, float *xs, float *ys) const;
+    bool span(int x0, int y, int n, float xmin, float ymin, float xmax, float ymax, int &lo, int &hi) const;
+private:
+    float m[6];
+};
+
+// Homogeneous 3x3 matrix (row major) from output to source coordinates
+class ProjectiveCoords : public RemapCoords {
+public:
+    ProjectiveCoords(const float h[9]);
+    void row(int x0, int y, int n, float *xs, float *ys) const;
+    // bounded only on the rows that do not cross the line at infinity
+    bool span(int x0, int y, int n, float xmin, float ymin, float xmax, float ymax, int &lo, int &hi) const;
+private:
+    float h[9];
+};
+
+// Polar coordinates around (cx, cy): the angle in [0, 2pi) and the radius
+// are mapped linearly to xs = angleOffset + angleScale*angle and
+// ys = radiusOffset + radiusScale*radius
+class PolarCoords : public RemapCoords {
+public:
+    PolarCoords(float cx, float cy, float angleScale, float angleOffset, float radiusScale, float radiusOffset);
+    void row(int x0, int y, int n, float *xs, float *ys) const;
+private:
+    float cx, cy, angleScale, angleOffset, radiusScale, radiusOffset;
+};
+
+// Explicit coordinate field: channel 0 of mapX and mapY, of the output size
+class FieldCoords : public RemapCoords {
+public:
+    FieldCoords(const Image &mapX, const Image &mapY);
+    void row(int x0, int y, int n, float *xs, float *ys) const;
+private:
+    const Image &mapX, &mapY;
+};
+
+enum RemapBorder {
+    REMAP_BLACK, // samples outside the source read as black
+    REMAP_CLAMP, // samples outside the source read the closest edge pixel
+    REMAP_SKIP   // pixels whose source is not in [0,w-1) x [0,h-1) are left unchanged
+};
+
+// Sample source at the generated coordinates into the region [x0,x1) x
+// [y0,y1) of out (the whole image when x1 or y1 is negative), with bilinear
+// or nearest neighbor interpolation. With a weight image, the samples are
+// instead added to out, scaled by the weight at the truncated source
+// position. Output tiles are processed in parallel. Each scanline is
+// clipped to the span whose samples are all inside the source, which is
+// gathered without tests, and only its ends go through the border policy.
+void remap(const Image &source, const RemapCoords &coords, Image &out,
+           bool bilinear=true, RemapBorder border=REMAP_BLACK, const Image *weight=NULL,
+           int x0=0, int y0=0, int x1=-1, int y1=-1);
+
+#endif